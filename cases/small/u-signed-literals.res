@@ -0,0 +1,2 @@
+s 0
+t 0
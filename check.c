@@ -0,0 +1,790 @@
+#include "check.h"
+#include "literal.h"
+#include "parallel.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// One contiguous range of input clauses evaluated by one thread
+typedef struct ModelChunk {
+	const OptCNF *cnf;
+	const Assignment *model;
+	size_t begin;
+	size_t end;
+	size_t failed;      // first clause not satisfied
+	int status;         // as check_model
+} ModelChunk;
+
+static void *model_chunk_worker(void *arg) {
+	ModelChunk *ch = (ModelChunk *)arg;
+	const ClauseArena *arena = &ch->cnf->arena;
+	const int *values = ch->model->values;
+	int nv = ch->model->num_variables;
+	ch->status = 1;
+	for (size_t i = ch->begin; i < ch->end; ++i) {
+		const ArenaClause *cl = arena_clause(arena, ch->cnf->clauses[i]);
+		int sat = 0;
+		for (uint32_t j = 0; j < cl->size && !sat; ++j) {
+			int lit = cl->lits[j];
+			int var = lit > 0 ? lit : -lit;
+			if (var < 1 || var > nv) {
+				ch->status = -1;
+				ch->failed = i;
+				return NULL;
+			}
+			sat = values[var] == (lit > 0 ? 1 : -1);
+		}
+		if (!sat) {
+			ch->status = 0;
+			ch->failed = i;
+			return NULL;
+		}
+	}
+	return NULL;
+}
+
+int check_model(const OptCNF *cnf, const Assignment *model, int threads, CheckStats *stats) {
+	if (!cnf || !model || !model->values) return -1;
+	double t0 = wall_ms();
+	if (threads <= 0) threads = cpu_count();
+	if (threads > CHECK_MAX_THREADS) threads = CHECK_MAX_THREADS;
+	size_t most = cnf->num_clauses / CHECK_MIN_CHUNK;
+	if ((size_t)threads > most) threads = most > 0 ? (int)most : 1;
+
+	ModelChunk chunks[CHECK_MAX_THREADS];
+	size_t per = cnf->num_clauses / (size_t)threads;
+	for (int k = 0; k < threads; ++k) {
+		chunks[k].cnf = cnf;
+		chunks[k].model = model;
+		chunks[k].begin = (size_t)k * per;
+		chunks[k].end = k == threads - 1 ? cnf->num_clauses : (size_t)(k + 1) * per;
+		chunks[k].failed = 0;
+	}
+	parallel_run(chunks, sizeof(ModelChunk), threads, model_chunk_worker, 1);
+
+	// The lowest failing chunk decides, as a sequential scan would
+	int r = 1;
+	size_t failed = 0;
+	for (int k = 0; k < threads && r == 1; ++k) {
+		r = chunks[k].status;
+		failed = chunks[k].failed;
+	}
+	if (stats) {
+		stats->threads = threads;
+		stats->failed_clause = r == 1 ? 0 : failed;
+		stats->ms = wall_ms() - t0;
+	}
+	return r;
+}
+
+// Checker clause flags, above the ARENA_CLAUSE_* bits
+enum {
+	CHECK_CLAUSE_ACTIVE = 8,
+	CHECK_CLAUSE_CORE = 16
+};
+
+enum {
+	CHECK_ITEM_ADD,
+	CHECK_ITEM_DELETE,
+	CHECK_ITEM_IGNORED  // deletion skipped by the forward pass, and so by the backward one
+};
+
+// A proof line; a DRAT deletion first refers to a copy of its literals and
+// is resolved to the clause it removes by the forward pass
+typedef struct CheckItem {
+	ClauseRef ref;      // CLAUSE_REF_UNDEF for tautologies and unknown LRAT ids
+	int kind;
+} CheckItem;
+
+typedef struct WatchList {
+	ClauseRef *data;
+	uint32_t size;
+	uint32_t cap;
+} WatchList;
+
+typedef struct Checker {
+	ClauseArena arena;
+	ClauseRef *inputs;
+	size_t num_inputs;
+	ClauseRef first_lemma;  // arena offsets from here on belong to the proof
+	CheckItem *items;
+	size_t num_items;
+	size_t items_cap;
+	int lrat;
+	ClauseRef *ids;         // LRAT id -> clause
+	size_t ids_cap;
+
+	// Literals of the clause being read, and duplicate detection
+	int *buf;
+	size_t buf_size;
+	size_t buf_cap;
+	uint32_t *stamp;        // per literal of the first stamp_vars variables
+	uint32_t cur_stamp;
+	int stamp_vars;
+	int max_var;
+
+	// Deleted clauses are found by an order-independent hash of their
+	// literals; the chains run through ArenaClause.u.forward
+	ClauseRef *buckets;
+	size_t num_buckets;
+
+	// Level-0 propagation over the active clauses
+	int num_vars;
+	signed char *vals;      // per literal
+	ClauseRef *reason;      // per variable; a reason's implied literal is lits[0]
+	int *pos;               // per variable: trail position
+	unsigned char *seen;
+	int *trail;
+	int trail_size;
+	int qhead;
+	int *scratch;
+	WatchList *watches;     // clauses whose lits[0] or lits[1] is the literal
+	int oom;
+
+	CheckStats stats;
+} Checker;
+
+static inline ArenaClause *ck_clause(const Checker *ck, ClauseRef ref) {
+	return arena_clause(&ck->arena, ref);
+}
+
+static void watch_push(Checker *ck, int lit, ClauseRef ref) {
+	WatchList *ws = &ck->watches[lit];
+	if (ws->size == ws->cap) {
+		uint32_t cap = ws->cap ? ws->cap * 2 : 4;
+		ClauseRef *data = (ClauseRef *)realloc(ws->data, cap * sizeof(ClauseRef));
+		if (!data) { ck->oom = 1; return; }
+		ws->data = data;
+		ws->cap = cap;
+	}
+	ws->data[ws->size++] = ref;
+}
+
+static void watch_remove(Checker *ck, int lit, ClauseRef ref) {
+	WatchList *ws = &ck->watches[lit];
+	for (uint32_t i = 0; i < ws->size; ++i) {
+		if (ws->data[i] == ref) {
+			ws->data[i] = ws->data[--ws->size];
+			return;
+		}
+	}
+}
+
+static void next_stamp(Checker *ck) {
+	if (++ck->cur_stamp == 0) {
+		memset(ck->stamp, 0, (size_t)(2 * ck->stamp_vars + 2) * sizeof(uint32_t));
+		ck->cur_stamp = 1;
+	}
+}
+
+// Make variable v known: proofs may use variables beyond the formula's
+static int grow_vars(Checker *ck, int v) {
+	if (v > ck->stamp_vars || !ck->stamp) {
+		int nv = v > 2 * ck->stamp_vars ? v : 2 * ck->stamp_vars;
+		size_t old = ck->stamp ? 2 * (size_t)ck->stamp_vars + 2 : 0;
+		uint32_t *stamp = (uint32_t *)realloc(ck->stamp, (2 * (size_t)nv + 2) * sizeof(uint32_t));
+		if (!stamp) return -1;
+		memset(stamp + old, 0, (2 * (size_t)nv + 2 - old) * sizeof(uint32_t));
+		ck->stamp = stamp;
+		ck->stamp_vars = nv;
+	}
+	if (v > ck->max_var) ck->max_var = v;
+	return 0;
+}
+
+// Append a packed literal to the clause being read
+static int push_lit(Checker *ck, int lit) {
+	if (lit_var(lit) > ck->max_var && grow_vars(ck, lit_var(lit)) != 0) return -1;
+	if (ck->buf_size == ck->buf_cap) {
+		size_t cap = ck->buf_cap ? ck->buf_cap * 2 : 64;
+		int *buf = (int *)realloc(ck->buf, cap * sizeof(int));
+		if (!buf) return -1;
+		ck->buf = buf;
+		ck->buf_cap = cap;
+	}
+	ck->buf[ck->buf_size++] = lit;
+	return 0;
+}
+
+// Store the literals read so far without duplicates; a tautology is kept
+// out of the arena (*out = CLAUSE_REF_UNDEF). Returns 0, -1 on failure.
+static int store_clause(Checker *ck, ClauseRef *out) {
+	next_stamp(ck);
+	uint32_t m = 0;
+	*out = CLAUSE_REF_UNDEF;
+	for (size_t i = 0; i < ck->buf_size; ++i) {
+		int l = ck->buf[i];
+		if (ck->stamp[lit_not(l)] == ck->cur_stamp) {
+			ck->buf_size = 0;
+			return 0;
+		}
+		if (ck->stamp[l] == ck->cur_stamp) continue;
+		ck->stamp[l] = ck->cur_stamp;
+		ck->buf[m++] = l;
+	}
+	ck->buf_size = 0;
+	*out = arena_alloc(&ck->arena, ck->buf, m);
+	return *out == CLAUSE_REF_UNDEF ? -1 : 0;
+}
+
+static int push_item(Checker *ck, ClauseRef ref, int kind) {
+	if (ck->num_items == ck->items_cap) {
+		size_t cap = ck->items_cap ? ck->items_cap * 2 : 1024;
+		CheckItem *items = (CheckItem *)realloc(ck->items, cap * sizeof(CheckItem));
+		if (!items) return -1;
+		ck->items = items;
+		ck->items_cap = cap;
+	}
+	ck->items[ck->num_items].ref = ref;
+	ck->items[ck->num_items].kind = kind;
+	ck->num_items++;
+	if (kind == CHECK_ITEM_ADD) ck->stats.lemmas++;
+	else ck->stats.deletions++;
+	return 0;
+}
+
+static int set_id(Checker *ck, uint64_t id, ClauseRef ref) {
+	if (id >= ck->ids_cap) {
+		size_t cap = ck->ids_cap ? ck->ids_cap : 1024;
+		while (cap <= id) cap *= 2;
+		ClauseRef *ids = (ClauseRef *)realloc(ck->ids, cap * sizeof(ClauseRef));
+		if (!ids) return -1;
+		for (size_t k = ck->ids_cap; k < cap; ++k) ids[k] = CLAUSE_REF_UNDEF;
+		ck->ids = ids;
+		ck->ids_cap = cap;
+	}
+	ck->ids[id] = ref;
+	return 0;
+}
+
+static int load_inputs(Checker *ck, const OptCNF *cnf) {
+	ck->inputs = (ClauseRef *)malloc((cnf->num_clauses + 1) * sizeof(ClauseRef));
+	if (!ck->inputs) return -1;
+	for (size_t i = 0; i < cnf->num_clauses; ++i) {
+		const ArenaClause *cl = arena_clause(&cnf->arena, cnf->clauses[i]);
+		for (uint32_t j = 0; j < cl->size; ++j) {
+			if (cl->lits[j] == 0 || push_lit(ck, lit_from_dimacs(cl->lits[j])) != 0) return -1;
+		}
+		ClauseRef ref;
+		if (store_clause(ck, &ref) != 0) return -1;
+		ck->inputs[ck->num_inputs++] = ref;
+		if (ck->lrat && set_id(ck, (uint64_t)i + 1, ref) != 0) return -1;
+	}
+	ck->first_lemma = ck->arena.size;
+	return 0;
+}
+
+static char *read_file(const char *path, size_t *len) {
+	FILE *fp = fopen(path, "rb");
+	if (!fp) return NULL;
+	size_t cap = 1 << 20, n = 0;
+	char *data = (char *)malloc(cap + 1);
+	while (data) {
+		n += fread(data + n, 1, cap - n, fp);
+		if (n < cap) break;
+		cap *= 2;
+		char *grown = (char *)realloc(data, cap + 1);
+		if (!grown) free(data);
+		data = grown;
+	}
+	if (data && ferror(fp)) {
+		free(data);
+		data = NULL;
+	}
+	fclose(fp);
+	if (data) data[n] = '\0';
+	*len = n;
+	return data;
+}
+
+static inline int is_space(char c) {
+	return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+// Next decimal integer at *p (which may be negative). Returns 0, -1 if
+// there is none.
+static int scan_int(const char **p, const char *end, long long *out) {
+	const char *s = *p;
+	while (s < end && is_space(*s)) ++s;
+	int neg = s < end && *s == '-';
+	if (neg) ++s;
+	if (s >= end || *s < '0' || *s > '9') return -1;
+	long long v = 0;
+	while (s < end && *s >= '0' && *s <= '9') {
+		v = v * 10 + (*s - '0');
+		if (v > (1LL << 62)) return -1;
+		++s;
+	}
+	*p = s;
+	*out = neg ? -v : v;
+	return 0;
+}
+
+// Text literals up to the closing 0 into ck->buf
+static int scan_lits(Checker *ck, const char **p, const char *end) {
+	for (;;) {
+		long long v;
+		if (scan_int(p, end, &v) != 0 || v > INT32_MAX / 2 || v < -(INT32_MAX / 2)) return -1;
+		if (v == 0) return 0;
+		if (push_lit(ck, lit_from_dimacs((int)v)) != 0) return -1;
+	}
+}
+
+static int parse_text(Checker *ck, const char *p, const char *end) {
+	for (;;) {
+		while (p < end && is_space(*p)) ++p;
+		if (p >= end) return 0;
+		if (*p == 'c') {
+			while (p < end && *p != '\n') ++p;
+			continue;
+		}
+		long long id = 0;
+		if (ck->lrat && scan_int(&p, end, &id) != 0) return -1;
+		while (p < end && is_space(*p)) ++p;
+		int del = p < end && *p == 'd';
+		if (del) ++p;
+		if (ck->lrat && del) {
+			// Deleted ids up to 0; unknown ones are left to the forward pass
+			for (;;) {
+				long long d;
+				if (scan_int(&p, end, &d) != 0) return -1;
+				if (d == 0) break;
+				ClauseRef ref = d > 0 && (size_t)d < ck->ids_cap ? ck->ids[d] : CLAUSE_REF_UNDEF;
+				if (push_item(ck, ref, CHECK_ITEM_DELETE) != 0) return -1;
+			}
+			continue;
+		}
+		ClauseRef ref;
+		if (scan_lits(ck, &p, end) != 0 || store_clause(ck, &ref) != 0) return -1;
+		if (push_item(ck, ref, del ? CHECK_ITEM_DELETE : CHECK_ITEM_ADD) != 0) return -1;
+		if (ck->lrat) {
+			// The hints are not needed: RUP finds the antecedents itself
+			long long h;
+			do {
+				if (scan_int(&p, end, &h) != 0) return -1;
+			} while (h != 0);
+			if (id <= 0 || set_id(ck, (uint64_t)id, ref) != 0) return -1;
+		}
+	}
+}
+
+static int parse_binary(Checker *ck, const unsigned char *p, const unsigned char *end) {
+	while (p < end) {
+		int kind;
+		if (*p == 'a') kind = CHECK_ITEM_ADD;
+		else if (*p == 'd') kind = CHECK_ITEM_DELETE;
+		else return -1;
+		++p;
+		for (;;) {
+			uint64_t v = 0;
+			int shift = 0;
+			do {
+				if (p >= end || shift > 56) return -1;
+				v |= (uint64_t)(*p & 0x7f) << shift;
+				shift += 7;
+			} while (*p++ & 0x80);
+			if (v == 0) break;
+			// Already the packed encoding
+			if (v < 2 || v > INT32_MAX || push_lit(ck, (int)v) != 0) return -1;
+		}
+		ClauseRef ref;
+		if (store_clause(ck, &ref) != 0 || push_item(ck, ref, kind) != 0) return -1;
+	}
+	return 0;
+}
+
+static uint32_t lits_hash(const int *lits, uint32_t n) {
+	uint32_t h = n;
+	for (uint32_t i = 0; i < n; ++i) {
+		uint32_t x = (uint32_t)lits[i] * 0x9E3779B1u;
+		h += x ^ (x >> 15);
+	}
+	return h;
+}
+
+static void hash_insert(Checker *ck, ClauseRef ref) {
+	ArenaClause *c = ck_clause(ck, ref);
+	size_t b = lits_hash(c->lits, c->size) & (ck->num_buckets - 1);
+	c->u.forward = ck->buckets[b];
+	ck->buckets[b] = ref;
+}
+
+// The active clause with the literals of the deletion at 'del', unlinked
+// from its chain; CLAUSE_REF_UNDEF if there is none
+static ClauseRef hash_take(Checker *ck, ClauseRef del) {
+	const ArenaClause *d = ck_clause(ck, del);
+	next_stamp(ck);
+	for (uint32_t i = 0; i < d->size; ++i) ck->stamp[d->lits[i]] = ck->cur_stamp;
+	ClauseRef *link = &ck->buckets[lits_hash(d->lits, d->size) & (ck->num_buckets - 1)];
+	while (*link != CLAUSE_REF_UNDEF) {
+		ClauseRef ref = *link;
+		ArenaClause *c = ck_clause(ck, ref);
+		uint32_t i = 0;
+		if (c->size == d->size) {
+			while (i < c->size && ck->stamp[c->lits[i]] == ck->cur_stamp) ++i;
+		}
+		if (c->size == d->size && i == c->size) {
+			*link = c->u.forward;
+			return ref;
+		}
+		link = &c->u.forward;
+	}
+	return CLAUSE_REF_UNDEF;
+}
+
+static void enqueue(Checker *ck, int lit, ClauseRef reason) {
+	int v = lit_var(lit);
+	ck->vals[lit] = LIT_TRUE;
+	ck->vals[lit_not(lit)] = LIT_FALSE;
+	ck->reason[v] = reason;
+	ck->pos[v] = ck->trail_size;
+	ck->trail[ck->trail_size++] = lit;
+}
+
+static void backtrack(Checker *ck, int size) {
+	for (int i = size; i < ck->trail_size; ++i) {
+		int lit = ck->trail[i];
+		ck->vals[lit] = LIT_UNDEF;
+		ck->vals[lit_not(lit)] = LIT_UNDEF;
+	}
+	ck->trail_size = size;
+	if (ck->qhead > size) ck->qhead = size;
+}
+
+// Returns a falsified clause, or CLAUSE_REF_UNDEF at the fixpoint
+static ClauseRef propagate(Checker *ck) {
+	while (ck->qhead < ck->trail_size) {
+		int false_lit = lit_not(ck->trail[ck->qhead++]);
+		WatchList *ws = &ck->watches[false_lit];
+		uint32_t i = 0, j = 0;
+		ck->stats.propagations++;
+		while (i < ws->size) {
+			ClauseRef ref = ws->data[i++];
+			ArenaClause *c = ck_clause(ck, ref);
+			int conflict = c->size == 1;
+			if (!conflict) {
+				if (c->lits[0] == false_lit) {
+					c->lits[0] = c->lits[1];
+					c->lits[1] = false_lit;
+				}
+				if (ck->vals[c->lits[0]] == LIT_TRUE) {
+					ws->data[j++] = ref;
+					continue;
+				}
+				uint32_t k = 2;
+				while (k < c->size && ck->vals[c->lits[k]] == LIT_FALSE) ++k;
+				if (k < c->size) {
+					c->lits[1] = c->lits[k];
+					c->lits[k] = false_lit;
+					watch_push(ck, c->lits[1], ref);
+					continue;
+				}
+				conflict = ck->vals[c->lits[0]] == LIT_FALSE;
+			}
+			ws->data[j++] = ref;
+			if (conflict) {
+				while (i < ws->size) ws->data[j++] = ws->data[i++];
+				ws->size = j;
+				return ref;
+			}
+			enqueue(ck, c->lits[0], ref);
+		}
+		ws->size = j;
+	}
+	return CLAUSE_REF_UNDEF;
+}
+
+// Watch the clause and propagate what it implies
+static ClauseRef activate(Checker *ck, ClauseRef ref) {
+	ArenaClause *c = ck_clause(ck, ref);
+	c->flags |= CHECK_CLAUSE_ACTIVE;
+	if (c->size == 0) return ref;
+	// True literals first, then unassigned ones
+	for (uint32_t slot = 0; slot < 2 && slot < c->size; ++slot) {
+		uint32_t best = slot;
+		for (uint32_t k = slot + 1; k < c->size; ++k) {
+			if (ck->vals[c->lits[k]] > ck->vals[c->lits[best]]) best = k;
+		}
+		int t = c->lits[slot];
+		c->lits[slot] = c->lits[best];
+		c->lits[best] = t;
+	}
+	watch_push(ck, c->lits[0], ref);
+	if (c->size > 1) watch_push(ck, c->lits[1], ref);
+	int first = ck->vals[c->lits[0]];
+	if (first == LIT_FALSE) return ref;
+	if (first == LIT_UNDEF && (c->size == 1 || ck->vals[c->lits[1]] == LIT_FALSE)) enqueue(ck, c->lits[0], ref);
+	return propagate(ck);
+}
+
+static inline int is_reason(const Checker *ck, ClauseRef ref) {
+	const ArenaClause *c = ck_clause(ck, ref);
+	return c->size > 0 && ck->vals[c->lits[0]] == LIT_TRUE && ck->reason[lit_var(c->lits[0])] == ref;
+}
+
+// Stop watching the clause. If it was the reason of a level-0 literal, that
+// literal and all later ones are unassigned and derived again from the
+// remaining clauses: a clause watching a removed literal may be unit now.
+static ClauseRef deactivate(Checker *ck, ClauseRef ref) {
+	ArenaClause *c = ck_clause(ck, ref);
+	c->flags &= (uint16_t)~CHECK_CLAUSE_ACTIVE;
+	if (c->size == 0) return CLAUSE_REF_UNDEF;
+	watch_remove(ck, c->lits[0], ref);
+	if (c->size > 1) watch_remove(ck, c->lits[1], ref);
+	if (!is_reason(ck, ref)) return CLAUSE_REF_UNDEF;
+
+	int from = ck->pos[lit_var(c->lits[0])];
+	int removed = ck->trail_size - from;
+	memcpy(ck->scratch, ck->trail + from, (size_t)removed * sizeof(int));
+	backtrack(ck, from);
+	for (int r = 0; r < removed; ++r) {
+		int t = ck->scratch[r];
+		WatchList *ws = &ck->watches[t];
+		for (uint32_t w = 0; w < ws->size && ck->vals[t] == LIT_UNDEF; ++w) {
+			ClauseRef other_ref = ws->data[w];
+			ArenaClause *d = ck_clause(ck, other_ref);
+			if (d->size > 1) {
+				// Left alone while the other watch is not false: it may be
+				// the implied lits[0] of a reason
+				int at = d->lits[0] == t ? 1 : 0;
+				int other = d->lits[at];
+				if (ck->vals[other] != LIT_FALSE) continue;
+				uint32_t k = 2;
+				while (k < d->size && ck->vals[d->lits[k]] == LIT_FALSE) ++k;
+				if (k < d->size) {
+					d->lits[at] = d->lits[k];
+					d->lits[k] = other;
+					watch_remove(ck, other, other_ref);
+					watch_push(ck, d->lits[at], other_ref);
+					continue;
+				}
+				d->lits[0] = t;
+				d->lits[1] = other;
+			}
+			enqueue(ck, t, other_ref);
+		}
+	}
+	return propagate(ck);
+}
+
+static void mark_core(Checker *ck, ClauseRef ref) {
+	ArenaClause *c = ck_clause(ck, ref);
+	if (c->flags & CHECK_CLAUSE_CORE) return;
+	c->flags |= CHECK_CLAUSE_CORE;
+	if (ref < ck->first_lemma) ck->stats.core_clauses++;
+}
+
+// Mark the clauses behind a conflict: the falsified clause (or the true
+// literal 'lit' when ref is undefined) and the reasons of every literal it
+// depends on, found walking the trail backward
+static void analyze(Checker *ck, ClauseRef ref, int lit) {
+	int pending = 0;
+	if (ref != CLAUSE_REF_UNDEF) {
+		const ArenaClause *c = ck_clause(ck, ref);
+		mark_core(ck, ref);
+		for (uint32_t k = 0; k < c->size; ++k) {
+			int v = lit_var(c->lits[k]);
+			if (!ck->seen[v]) {
+				ck->seen[v] = 1;
+				pending++;
+			}
+		}
+	} else {
+		ck->seen[lit_var(lit)] = 1;
+		pending = 1;
+	}
+	for (int i = ck->trail_size - 1; i >= 0 && pending > 0; --i) {
+		int v = lit_var(ck->trail[i]);
+		if (!ck->seen[v]) continue;
+		ck->seen[v] = 0;
+		pending--;
+		ClauseRef r = ck->reason[v];
+		if (r == CLAUSE_REF_UNDEF) continue;
+		mark_core(ck, r);
+		const ArenaClause *c = ck_clause(ck, r);
+		for (uint32_t k = 1; k < c->size; ++k) {
+			int u = lit_var(c->lits[k]);
+			if (!ck->seen[u]) {
+				ck->seen[u] = 1;
+				pending++;
+			}
+		}
+	}
+}
+
+// Reverse unit propagation: assert the negation of the lemma and expect a
+// conflict; the clauses it used become core
+static int check_rup(Checker *ck, ClauseRef ref) {
+	const ArenaClause *c = ck_clause(ck, ref);
+	int saved = ck->trail_size;
+	int true_lit = -1;
+	for (uint32_t k = 0; k < c->size && true_lit < 0; ++k) {
+		int l = c->lits[k];
+		if (ck->vals[l] == LIT_TRUE) true_lit = l;
+		else if (ck->vals[l] == LIT_UNDEF) enqueue(ck, lit_not(l), CLAUSE_REF_UNDEF);
+	}
+	ClauseRef conflict = true_lit < 0 ? propagate(ck) : CLAUSE_REF_UNDEF;
+	int ok = true_lit >= 0 || conflict != CLAUSE_REF_UNDEF;
+	if (ok) analyze(ck, conflict, true_lit);
+	backtrack(ck, saved);
+	return ok;
+}
+
+static int init_search(Checker *ck, int nv) {
+	ck->num_vars = nv;
+	size_t nl = 2 * (size_t)nv + 2;
+	ck->vals = (signed char *)calloc(nl, 1);
+	ck->reason = (ClauseRef *)malloc(((size_t)nv + 1) * sizeof(ClauseRef));
+	ck->pos = (int *)malloc(((size_t)nv + 1) * sizeof(int));
+	ck->seen = (unsigned char *)calloc((size_t)nv + 1, 1);
+	ck->trail = (int *)malloc(((size_t)nv + 1) * sizeof(int));
+	ck->scratch = (int *)malloc(((size_t)nv + 1) * sizeof(int));
+	ck->watches = (WatchList *)calloc(nl, sizeof(WatchList));
+	size_t clauses = ck->num_inputs + ck->stats.lemmas + 1;
+	ck->num_buckets = 1024;
+	while (ck->num_buckets < clauses) ck->num_buckets *= 2;
+	ck->buckets = (ClauseRef *)malloc(ck->num_buckets * sizeof(ClauseRef));
+	if (!ck->vals || !ck->reason || !ck->pos || !ck->seen || !ck->trail || !ck->scratch || !ck->watches ||
+		!ck->buckets) {
+		return -1;
+	}
+	for (size_t b = 0; b < ck->num_buckets; ++b) ck->buckets[b] = CLAUSE_REF_UNDEF;
+	return 0;
+}
+
+static void free_checker(Checker *ck) {
+	arena_free(&ck->arena);
+	free(ck->inputs);
+	free(ck->items);
+	free(ck->ids);
+	free(ck->buf);
+	free(ck->stamp);
+	free(ck->buckets);
+	free(ck->vals);
+	free(ck->reason);
+	free(ck->pos);
+	free(ck->seen);
+	free(ck->trail);
+	free(ck->scratch);
+	if (ck->watches) {
+		for (size_t l = 0; l < 2 * (size_t)ck->num_vars + 2; ++l) free(ck->watches[l].data);
+	}
+	free(ck->watches);
+}
+
+// Replay the proof up to the first conflict of unit propagation. Returns 1
+// with the conflict and the number of items taken, 0 if the proof ends
+// without one (failed_lemma is then 0, or the empty clause's position),
+// -1 on allocation failure.
+static int forward_pass(Checker *ck, size_t *stop, ClauseRef *conflict) {
+	*stop = 0;
+	*conflict = CLAUSE_REF_UNDEF;
+	for (size_t i = 0; i < ck->num_inputs; ++i) {
+		ClauseRef ref = ck->inputs[i];
+		if (ref == CLAUSE_REF_UNDEF) continue;
+		if (!ck->lrat) hash_insert(ck, ref);
+		*conflict = activate(ck, ref);
+		if (*conflict != CLAUSE_REF_UNDEF) return 1;
+	}
+	unsigned long lemma = 0;
+	for (size_t i = 0; i < ck->num_items; ++i) {
+		CheckItem *it = &ck->items[i];
+		if (ck->oom) return -1;
+		if (it->kind == CHECK_ITEM_ADD) {
+			lemma++;
+			if (it->ref == CLAUSE_REF_UNDEF) continue;
+			if (ck_clause(ck, it->ref)->size == 0) {
+				// Unit propagation is at a fixpoint without conflict
+				ck->stats.failed_lemma = lemma;
+				return 0;
+			}
+			if (!ck->lrat) hash_insert(ck, it->ref);
+			*conflict = activate(ck, it->ref);
+			if (*conflict != CLAUSE_REF_UNDEF) {
+				*stop = i + 1;
+				return 1;
+			}
+			continue;
+		}
+		ClauseRef ref = it->ref;
+		if (!ck->lrat && ref != CLAUSE_REF_UNDEF) ref = hash_take(ck, ref);
+		else if (ref != CLAUSE_REF_UNDEF && !(ck_clause(ck, ref)->flags & CHECK_CLAUSE_ACTIVE)) ref = CLAUSE_REF_UNDEF;
+		// Units stay: deleting a reason would unassign what follows from it
+		if (ref != CLAUSE_REF_UNDEF && is_reason(ck, ref)) {
+			if (!ck->lrat) hash_insert(ck, ref);
+			ref = CLAUSE_REF_UNDEF;
+		}
+		if (ref == CLAUSE_REF_UNDEF) {
+			it->kind = CHECK_ITEM_IGNORED;
+			ck->stats.ignored_deletions++;
+			continue;
+		}
+		it->ref = ref;
+		deactivate(ck, ref);
+	}
+	return 0;
+}
+
+// Undo the proof from the conflict backward, checking every core lemma
+// against the clauses active before it
+static int backward_pass(Checker *ck, size_t stop, ClauseRef conflict) {
+	analyze(ck, conflict, -1);
+	unsigned long lemma = 0;
+	for (size_t i = 0; i < stop; ++i) lemma += ck->items[i].kind == CHECK_ITEM_ADD;
+	for (size_t i = stop; i-- > 0;) {
+		const CheckItem *it = &ck->items[i];
+		if (ck->oom) return -1;
+		if (it->kind == CHECK_ITEM_IGNORED) continue;
+		if (it->kind == CHECK_ITEM_DELETE) {
+			// Active again; the clauses at this point propagated without conflict
+			if (activate(ck, it->ref) != CLAUSE_REF_UNDEF) return -1;
+			continue;
+		}
+		unsigned long index = lemma--;
+		if (it->ref == CLAUSE_REF_UNDEF) continue;
+		deactivate(ck, it->ref);
+		if (!(ck_clause(ck, it->ref)->flags & CHECK_CLAUSE_CORE)) continue;
+		ck->stats.core_lemmas++;
+		if (!check_rup(ck, it->ref)) {
+			ck->stats.failed_lemma = index;
+			return 0;
+		}
+	}
+	return 1;
+}
+
+int check_proof(const OptCNF *cnf, const char *path, ProofFormat format, CheckStats *stats) {
+	if (!cnf || !path) return -1;
+	double t0 = wall_ms();
+	Checker ck;
+	memset(&ck, 0, sizeof(ck));
+	ck.lrat = format == PROOF_LRAT;
+	size_t len = 0;
+	char *data = NULL;
+	int r = -1;
+	if (arena_init(&ck.arena, cnf->arena.size + 1024) != 0 || grow_vars(&ck, cnf->num_variables) != 0) goto done;
+	if (load_inputs(&ck, cnf) != 0) goto done;
+	data = read_file(path, &len);
+	if (!data) goto done;
+	if (format == PROOF_DRAT_BINARY) {
+		if (parse_binary(&ck, (const unsigned char *)data, (const unsigned char *)data + len) != 0) goto done;
+	} else if (parse_text(&ck, data, data + len) != 0) {
+		goto done;
+	}
+	free(data);
+	data = NULL;
+	if (init_search(&ck, ck.max_var) != 0) goto done;
+
+	size_t stop;
+	ClauseRef conflict;
+	r = forward_pass(&ck, &stop, &conflict);
+	if (r == 1) r = backward_pass(&ck, stop, conflict);
+	if (ck.oom) r = -1;
+
+done:
+	free(data);
+	ck.stats.ms = wall_ms() - t0;
+	if (stats) *stats = ck.stats;
+	free_checker(&ck);
+	return r;
+}
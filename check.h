@@ -0,0 +1,40 @@
+// check.h - Independent checks of answers: models against the parsed formula, UNSAT proofs backward
+#ifndef SAT_CHECK_H
+#define SAT_CHECK_H
+
+#include "solver.h"
+#include "proof.h"
+
+// Clauses per model-checking thread below which no more threads are started
+#define CHECK_MIN_CHUNK (1u << 16)
+#define CHECK_MAX_THREADS 64
+
+typedef struct CheckStats {
+	int threads;                    // threads used by check_model
+	size_t failed_clause;           // first input clause the model falsifies
+	unsigned long lemmas;           // clauses added by the proof
+	unsigned long deletions;
+	unsigned long ignored_deletions; // unknown clauses, or reasons of level-0 units
+	unsigned long core_lemmas;      // lemmas the refutation depends on, each checked by RUP
+	unsigned long core_clauses;     // input clauses the refutation depends on
+	unsigned long failed_lemma;     // 1-based position of the first lemma that is not RUP
+	unsigned long propagations;
+	double ms;
+} CheckStats;
+
+// Evaluate every clause of 'cnf' under 'model' on up to 'threads' threads
+// (<= 0: one per online CPU), each taking a contiguous range of clauses.
+// Returns 1 if all are satisfied, 0 if not (stats->failed_clause is the
+// first one), -1 if a literal lies outside the model. stats may be NULL.
+int check_model(const OptCNF *cnf, const Assignment *model, int threads, CheckStats *stats);
+
+// Verify that the proof at 'path' refutes 'cnf'. Lemmas are replayed with
+// watched-literal propagation up to the first conflict, then checked
+// backward by reverse unit propagation; only lemmas that the conflict, or
+// an already checked lemma, depends on are checked. LRAT files are
+// checked the same way, ignoring their hints. RAT lemmas are not accepted:
+// the solver and the preprocessor only emit RUP ones.
+// Returns 1 if valid, 0 if not, -1 on read or allocation errors.
+int check_proof(const OptCNF *cnf, const char *path, ProofFormat format, CheckStats *stats);
+
+#endif // SAT_CHECK_H
@@ -0,0 +1,58 @@
+#include "clause_arena.h"
+#include <stdlib.h>
+#include <string.h>
+
+typedef char arena_header_is_three_words[(sizeof(ArenaClause) == ARENA_HEADER_WORDS * sizeof(uint32_t)) ? 1 : -1];
+
+int arena_init(ClauseArena *a, size_t cap_words) {
+	if (!a) return -1;
+	memset(a, 0, sizeof(*a));
+	if (cap_words < 16) cap_words = 16;
+	if (cap_words > UINT32_MAX) return -1;
+	a->mem = (uint32_t *)malloc(cap_words * sizeof(uint32_t));
+	if (!a->mem) return -1;
+	a->cap = (uint32_t)cap_words;
+	return 0;
+}
+
+void arena_free(ClauseArena *a) {
+	if (!a) return;
+	free(a->mem);
+	memset(a, 0, sizeof(*a));
+}
+
+int arena_reserve(ClauseArena *a, size_t extra_words) {
+	size_t need = (size_t)a->size + extra_words;
+	if (need <= a->cap) return 0;
+	// Offsets must stay below CLAUSE_REF_UNDEF
+	if (need >= (size_t)UINT32_MAX) return -1;
+	size_t new_cap = a->cap ? (size_t)a->cap : 16;
+	while (new_cap < need) new_cap += new_cap / 2 + 16;
+	if (new_cap >= (size_t)UINT32_MAX) new_cap = (size_t)UINT32_MAX - 1;
+	uint32_t *mem = (uint32_t *)realloc(a->mem, new_cap * sizeof(uint32_t));
+	if (!mem) return -1;
+	a->mem = mem;
+	a->cap = (uint32_t)new_cap;
+	return 0;
+}
+
+ClauseRef arena_alloc(ClauseArena *a, const int *lits, uint32_t n) {
+	if (arena_reserve(a, arena_clause_words(n)) != 0) return CLAUSE_REF_UNDEF;
+	ClauseRef ref = a->size;
+	ArenaClause *c = arena_clause(a, ref);
+	c->size = n;
+	c->flags = 0;
+	c->lbd = 0;
+	c->u.activity = 0.0f;
+	if (n) memcpy(c->lits, lits, (size_t)n * sizeof(int));
+	a->size += arena_clause_words(n);
+	return ref;
+}
+
+int arena_copy(ClauseArena *dst, const ClauseArena *src) {
+	if (arena_init(dst, src->size) != 0) return -1;
+	memcpy(dst->mem, src->mem, (size_t)src->size * sizeof(uint32_t));
+	dst->size = src->size;
+	dst->wasted = src->wasted;
+	return 0;
+}
@@ -0,0 +1,70 @@
+// clause_arena.h - Contiguous clause storage addressed by 32-bit offsets
+#ifndef SAT_CLAUSE_ARENA_H
+#define SAT_CLAUSE_ARENA_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Offset of a clause header in ClauseArena.mem (in 32-bit words)
+typedef uint32_t ClauseRef;
+#define CLAUSE_REF_UNDEF UINT32_MAX
+
+// Clause layout inside the arena: a three-word header followed by the literals
+typedef struct ArenaClause {
+	uint32_t size;      // number of literals
+	uint16_t flags;     // ARENA_CLAUSE_* bits (the solver keeps tier bits above them)
+	uint16_t lbd;       // literal block distance of learned clauses
+	union {
+		float activity;     // learned clause activity
+		ClauseRef forward;  // new location while the arena is being compacted
+	} u;
+	int lits[];
+} ArenaClause;
+
+#define ARENA_HEADER_WORDS 3
+
+enum {
+	ARENA_CLAUSE_LEARNT = 1,
+	ARENA_CLAUSE_DELETED = 2,
+	ARENA_CLAUSE_RELOCATED = 4
+};
+
+typedef struct ClauseArena {
+	uint32_t *mem;
+	uint32_t size;      // words in use
+	uint32_t cap;       // words allocated
+	uint32_t wasted;    // words held by deleted clauses
+} ClauseArena;
+
+// Initialize an empty arena with room for cap_words words. Returns 0 on success.
+int arena_init(ClauseArena *a, size_t cap_words);
+
+void arena_free(ClauseArena *a);
+
+// Make room for extra_words more words. Returns 0 on success, -1 if the
+// arena would exceed the 32-bit offset range or allocation fails.
+int arena_reserve(ClauseArena *a, size_t extra_words);
+
+// Append a clause with the given literals and zeroed header fields.
+// Returns its reference, or CLAUSE_REF_UNDEF on failure.
+ClauseRef arena_alloc(ClauseArena *a, const int *lits, uint32_t n);
+
+// Copy the used part of src into dst (initialized here). Returns 0 on success.
+int arena_copy(ClauseArena *dst, const ClauseArena *src);
+
+static inline ArenaClause *arena_clause(const ClauseArena *a, ClauseRef ref) {
+	return (ArenaClause *)(a->mem + ref);
+}
+
+static inline uint32_t arena_clause_words(uint32_t num_literals) {
+	return ARENA_HEADER_WORDS + num_literals;
+}
+
+// Mark a clause deleted; its words are reclaimed by the next compaction
+static inline void arena_delete(ClauseArena *a, ClauseRef ref) {
+	ArenaClause *c = arena_clause(a, ref);
+	c->flags |= ARENA_CLAUSE_DELETED;
+	a->wasted += arena_clause_words(c->size);
+}
+
+#endif // SAT_CLAUSE_ARENA_H
@@ -0,0 +1,219 @@
+#include "cnf_cache.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#define CACHE_BYTE_ORDER 0x01020304u
+
+void cnf_cache_path(const char *source_path, char *buf, size_t buf_size) {
+	snprintf(buf, buf_size, "%s.cache", source_path);
+}
+
+// FNV-1a over 32-bit words in four independent lanes so it keeps up with
+// the page-in; seeded to chain the offset table into the arena
+static uint64_t cache_hash(const uint32_t *w, size_t n, uint64_t seed) {
+	const uint64_t prime = 1099511628211ULL;
+	uint64_t h0 = seed, h1 = seed ^ 1, h2 = seed ^ 2, h3 = seed ^ 3;
+	size_t i = 0;
+	for (; i + 4 <= n; i += 4) {
+		h0 = (h0 ^ w[i]) * prime;
+		h1 = (h1 ^ w[i + 1]) * prime;
+		h2 = (h2 ^ w[i + 2]) * prime;
+		h3 = (h3 ^ w[i + 3]) * prime;
+	}
+	for (; i < n; ++i) h0 = (h0 ^ w[i]) * prime;
+	return (((h0 * prime) ^ h1) * prime ^ h2) * prime ^ h3;
+}
+
+static uint64_t cache_checksum(const ClauseRef *refs, size_t num_clauses, const uint32_t *words, size_t num_words) {
+	uint64_t h = cache_hash(refs, num_clauses, 14695981039346656037ULL);
+	return cache_hash(words, num_words, h);
+}
+
+static size_t arena_offset(uint64_t num_clauses) {
+	size_t off = sizeof(CnfCacheHeader) + (size_t)num_clauses * sizeof(ClauseRef);
+	return (off + 7) & ~(size_t)7;
+}
+
+// Header fields naming the current state of the source file
+typedef struct SourceStamp {
+	uint64_t size;
+	int64_t mtime;
+	int64_t mtime_ns;
+	int64_t ctime;
+	int64_t ctime_ns;
+	uint64_t ino;
+	uint64_t dev;
+} SourceStamp;
+
+static int source_stat(const char *path, SourceStamp *s) {
+	struct stat st;
+	if (stat(path, &st) != 0) return -1;
+	memset(s, 0, sizeof(*s));
+	s->size = (uint64_t)st.st_size;
+	s->mtime = (int64_t)st.st_mtime;
+	s->ctime = (int64_t)st.st_ctime;
+#if defined(__APPLE__)
+	s->mtime_ns = (int64_t)st.st_mtimespec.tv_nsec;
+	s->ctime_ns = (int64_t)st.st_ctimespec.tv_nsec;
+#elif !defined(_WIN32)
+	s->mtime_ns = (int64_t)st.st_mtim.tv_nsec;
+	s->ctime_ns = (int64_t)st.st_ctim.tv_nsec;
+#endif
+#ifndef _WIN32
+	// Not meaningful in the Windows C runtime's stat
+	s->ino = (uint64_t)st.st_ino;
+	s->dev = (uint64_t)st.st_dev;
+#endif
+	return 0;
+}
+
+int cnf_cache_write(const char *cache_path, const char *source_path, const OptCNF *cnf) {
+	if (!cache_path || !source_path || !cnf) return -1;
+	CnfCacheHeader hdr;
+	memset(&hdr, 0, sizeof(hdr));
+	memcpy(hdr.magic, CNF_CACHE_MAGIC, sizeof(hdr.magic));
+	hdr.version = CNF_CACHE_VERSION;
+	hdr.byte_order = CACHE_BYTE_ORDER;
+	SourceStamp src;
+	if (source_stat(source_path, &src) != 0) return -1;
+	hdr.source_size = src.size;
+	hdr.source_mtime = src.mtime;
+	hdr.source_mtime_ns = src.mtime_ns;
+	hdr.source_ctime = src.ctime;
+	hdr.source_ctime_ns = src.ctime_ns;
+	hdr.source_ino = src.ino;
+	hdr.source_dev = src.dev;
+	hdr.num_clauses = cnf->num_clauses;
+	hdr.arena_words = cnf->arena.size;
+	hdr.num_variables = (uint32_t)cnf->num_variables;
+	hdr.checksum = cache_checksum(cnf->clauses, cnf->num_clauses, cnf->arena.mem, cnf->arena.size);
+
+	char tmp[4096];
+	if ((size_t)snprintf(tmp, sizeof(tmp), "%s.tmp", cache_path) >= sizeof(tmp)) return -1;
+	FILE *fp = fopen(tmp, "wb");
+	if (!fp) return -1;
+	static const char zeros[8] = {0};
+	size_t pad = arena_offset(hdr.num_clauses) - sizeof(hdr) - cnf->num_clauses * sizeof(ClauseRef);
+	int ok = fwrite(&hdr, sizeof(hdr), 1, fp) == 1
+		&& fwrite(cnf->clauses, sizeof(ClauseRef), cnf->num_clauses, fp) == cnf->num_clauses
+		&& fwrite(zeros, 1, pad, fp) == pad
+		&& fwrite(cnf->arena.mem, sizeof(uint32_t), cnf->arena.size, fp) == cnf->arena.size;
+	if (fclose(fp) != 0) ok = 0;
+#ifdef _WIN32
+	if (ok) remove(cache_path);
+#endif
+	if (!ok || rename(tmp, cache_path) != 0) {
+		remove(tmp);
+		return -1;
+	}
+	return 0;
+}
+
+// 0 if hdr describes a cache of the current source in a file of file_size
+// bytes, 1 if it is stale, -1 if it is not a valid cache
+static int check_header(const CnfCacheHeader *hdr, uint64_t file_size, const char *source_path) {
+	if (memcmp(hdr->magic, CNF_CACHE_MAGIC, sizeof(hdr->magic)) != 0 || hdr->version != CNF_CACHE_VERSION ||
+		hdr->byte_order != CACHE_BYTE_ORDER) {
+		return -1;
+	}
+	if (hdr->arena_words >= UINT32_MAX || hdr->num_clauses > hdr->arena_words || hdr->num_variables > INT32_MAX) {
+		return -1;
+	}
+	if (file_size != arena_offset(hdr->num_clauses) + hdr->arena_words * sizeof(uint32_t)) return -1;
+	SourceStamp src;
+	if (source_stat(source_path, &src) != 0) return 1;
+	int same = src.size == hdr->source_size && src.mtime == hdr->source_mtime &&
+		src.mtime_ns == hdr->source_mtime_ns && src.ctime == hdr->source_ctime &&
+		src.ctime_ns == hdr->source_ctime_ns && src.ino == hdr->source_ino && src.dev == hdr->source_dev;
+	return same ? 0 : 1;
+}
+
+#ifndef _WIN32
+
+int cnf_cache_load(const char *cache_path, const char *source_path, OptCNF *out) {
+	if (!cache_path || !source_path || !out) return -1;
+	memset(out, 0, sizeof(*out));
+	int fd = open(cache_path, O_RDONLY);
+	if (fd < 0) return 1;
+	struct stat st;
+	if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(CnfCacheHeader)) { close(fd); return -1; }
+	size_t len = (size_t)st.st_size;
+	void *base = mmap(NULL, len, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (base == MAP_FAILED) return -1;
+	const CnfCacheHeader *hdr = (const CnfCacheHeader *)base;
+	int r = check_header(hdr, len, source_path);
+	if (r != 0) { munmap(base, len); return r; }
+	const char *bytes = (const char *)base;
+	ClauseRef *refs = (ClauseRef *)(bytes + sizeof(CnfCacheHeader));
+	uint32_t *words = (uint32_t *)(bytes + arena_offset(hdr->num_clauses));
+	if (cache_checksum(refs, hdr->num_clauses, words, hdr->arena_words) != hdr->checksum) {
+		munmap(base, len);
+		return -1;
+	}
+	out->num_variables = (int)hdr->num_variables;
+	out->num_clauses = hdr->num_clauses;
+	out->clauses = refs;
+	out->clauses_cap = hdr->num_clauses;
+	out->arena.mem = words;
+	out->arena.size = (uint32_t)hdr->arena_words;
+	out->arena.cap = (uint32_t)hdr->arena_words;
+	out->map = base;
+	out->map_len = len;
+	return 0;
+}
+
+void cnf_cache_unmap(OptCNF *cnf) {
+	if (!cnf || !cnf->map) return;
+	munmap(cnf->map, cnf->map_len);
+	memset(cnf, 0, sizeof(*cnf));
+}
+
+#else
+
+// No mmap: read the two sections into ordinary heap arrays
+int cnf_cache_load(const char *cache_path, const char *source_path, OptCNF *out) {
+	if (!cache_path || !source_path || !out) return -1;
+	memset(out, 0, sizeof(*out));
+	struct stat st;
+	if (stat(cache_path, &st) != 0) return 1;
+	FILE *fp = fopen(cache_path, "rb");
+	if (!fp) return 1;
+	CnfCacheHeader hdr;
+	if (fread(&hdr, sizeof(hdr), 1, fp) != 1) { fclose(fp); return -1; }
+	int r = check_header(&hdr, (uint64_t)st.st_size, source_path);
+	if (r != 0) { fclose(fp); return r; }
+	out->num_variables = (int)hdr.num_variables;
+	out->clauses_cap = hdr.num_clauses ? (size_t)hdr.num_clauses : 1;
+	out->clauses = (ClauseRef *)malloc(out->clauses_cap * sizeof(ClauseRef));
+	if (!out->clauses || arena_init(&out->arena, (size_t)hdr.arena_words) != 0 ||
+		fread(out->clauses, sizeof(ClauseRef), (size_t)hdr.num_clauses, fp) != hdr.num_clauses ||
+		fseek(fp, (long)arena_offset(hdr.num_clauses), SEEK_SET) != 0 ||
+		fread(out->arena.mem, sizeof(uint32_t), (size_t)hdr.arena_words, fp) != hdr.arena_words) {
+		fclose(fp);
+		free_opt_cnf(out);
+		return -1;
+	}
+	fclose(fp);
+	out->num_clauses = (size_t)hdr.num_clauses;
+	out->arena.size = (uint32_t)hdr.arena_words;
+	if (cache_checksum(out->clauses, out->num_clauses, out->arena.mem, out->arena.size) != hdr.checksum) {
+		free_opt_cnf(out);
+		return -1;
+	}
+	return 0;
+}
+
+void cnf_cache_unmap(OptCNF *cnf) {
+	(void)cnf;
+}
+
+#endif
@@ -0,0 +1,54 @@
+// cnf_cache.h - Binary CNF cache that loads straight into a clause arena
+#ifndef SAT_CNF_CACHE_H
+#define SAT_CNF_CACHE_H
+
+#include "parser_opt.h"
+
+// File layout (native byte order, checked on load):
+//   CnfCacheHeader
+//   num_clauses ClauseRef offsets, in input order
+//   padding to 8 bytes
+//   arena_words words of the clause arena, exactly as the parser built it
+// so loading is one mapping: OptCNF.clauses and OptCNF.arena.mem point into it.
+typedef struct CnfCacheHeader {
+	char magic[8];          // CNF_CACHE_MAGIC
+	uint32_t version;
+	uint32_t byte_order;    // 0x01020304 as written by the producing machine
+	// Identity of the text the cache was built from: ctime also moves when a
+	// copy keeps the old mtime (cp -p, rsync, tar), nanoseconds catch edits
+	// within the same second
+	uint64_t source_size;
+	int64_t source_mtime;
+	int64_t source_mtime_ns;
+	int64_t source_ctime;
+	int64_t source_ctime_ns;
+	uint64_t source_ino;
+	uint64_t source_dev;
+	uint64_t num_clauses;
+	uint64_t arena_words;
+	uint32_t num_variables;
+	uint32_t reserved;
+	uint64_t checksum;      // over the offset table and the arena
+} CnfCacheHeader;
+
+#define CNF_CACHE_MAGIC "SATCNF\0\0"
+#define CNF_CACHE_VERSION 2
+
+// Default cache file for an input: "<source>.cache"
+void cnf_cache_path(const char *source_path, char *buf, size_t buf_size);
+
+// Write cnf as the cache of source_path. The file is written next to its
+// final name and renamed into place. Returns 0 on success.
+int cnf_cache_write(const char *cache_path, const char *source_path, const OptCNF *cnf);
+
+// Load a cache of source_path. Returns 0 on success, 1 if the cache is
+// missing or stale (the source's size, mtime, ctime, inode or device
+// changed), -1 if it is unreadable or fails the checksum. On success the
+// formula is read-only when mapped: opt_cnf_add_clause refuses it. Release
+// it with free_opt_cnf.
+int cnf_cache_load(const char *cache_path, const char *source_path, OptCNF *out);
+
+// Unmap a loaded cache (called by free_opt_cnf)
+void cnf_cache_unmap(OptCNF *cnf);
+
+#endif // SAT_CNF_CACHE_H
@@ -0,0 +1,79 @@
+#include "cnf_input.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#define INPUT_READ_CHUNK (1u << 20)
+
+// Slurp a stream in large blocks; used for pipes and when mapping fails
+static int read_all(FILE *fp, CnfInput *in) {
+	size_t cap = INPUT_READ_CHUNK, len = 0;
+	char *buf = (char *)malloc(cap);
+	if (!buf) return -1;
+	for (;;) {
+		if (cap - len < INPUT_READ_CHUNK) {
+			size_t new_cap = cap * 2;
+			char *nb = (char *)realloc(buf, new_cap);
+			if (!nb) { free(buf); return -1; }
+			buf = nb;
+			cap = new_cap;
+		}
+		size_t got = fread(buf + len, 1, cap - len, fp);
+		len += got;
+		if (got == 0) break;
+	}
+	if (ferror(fp)) { free(buf); return -1; }
+	in->owned = buf;
+	in->data = buf;
+	in->size = len;
+	return 0;
+}
+
+#ifndef _WIN32
+static int map_file(const char *path, CnfInput *in) {
+	int fd = open(path, O_RDONLY);
+	if (fd < 0) return -1;
+	struct stat st;
+	if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size <= 0) { close(fd); return -1; }
+	void *base = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (base == MAP_FAILED) return -1;
+#ifdef MADV_SEQUENTIAL
+	madvise(base, (size_t)st.st_size, MADV_SEQUENTIAL);
+#endif
+	in->map = base;
+	in->map_len = (size_t)st.st_size;
+	in->data = (const char *)base;
+	in->size = (size_t)st.st_size;
+	return 0;
+}
+#endif
+
+int cnf_input_open(const char *path, CnfInput *in) {
+	if (!path || !in) return -1;
+	memset(in, 0, sizeof(*in));
+#ifndef _WIN32
+	if (map_file(path, in) == 0) return 0;
+#endif
+	FILE *fp = fopen(path, "rb");
+	if (!fp) return -1;
+	int r = read_all(fp, in);
+	fclose(fp);
+	return r;
+}
+
+void cnf_input_close(CnfInput *in) {
+	if (!in) return;
+#ifndef _WIN32
+	if (in->map) munmap(in->map, in->map_len);
+#endif
+	free(in->owned);
+	memset(in, 0, sizeof(*in));
+}
@@ -0,0 +1,23 @@
+// cnf_input.h - Whole-file input buffers for the DIMACS parsers
+#ifndef SAT_CNF_INPUT_H
+#define SAT_CNF_INPUT_H
+
+#include <stddef.h>
+
+// Read-only view of an entire input file. Regular files are memory-mapped;
+// pipes, character devices and platforms without mmap fall back to large
+// buffered reads into an owned heap block.
+typedef struct CnfInput {
+	const char *data;
+	size_t size;
+	void *map;          // mapping base, NULL if not mapped
+	size_t map_len;
+	char *owned;        // heap copy when the input could not be mapped
+} CnfInput;
+
+// Open 'path' and expose its contents. Returns 0 on success.
+int cnf_input_open(const char *path, CnfInput *in);
+
+void cnf_input_close(CnfInput *in);
+
+#endif // SAT_CNF_INPUT_H
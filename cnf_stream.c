@@ -0,0 +1,475 @@
+#include "cnf_stream.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef CNF_HAVE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef CNF_HAVE_LZMA
+#include <lzma.h>
+#endif
+#ifdef CNF_HAVE_BZIP2
+#include <bzlib.h>
+#endif
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#endif
+
+#ifndef STREAM_BLOCK
+#define STREAM_BLOCK (4u << 20)         // decoded bytes per block
+#endif
+#define STREAM_SLOTS 4                  // blocks in flight between the two threads
+#ifndef STREAM_READ_CHUNK
+#define STREAM_READ_CHUNK (256u << 10)  // raw bytes per fread
+#endif
+#define STREAM_MAGIC_MAX 6
+
+typedef struct StreamBlock {
+	char *data;
+	size_t len;
+	size_t cap;
+} StreamBlock;
+
+struct CnfStream {
+	FILE *fp;
+	int owns_fp;
+	CnfFormat format;
+
+	// Raw input. Initially holds the magic bytes read for detection, so the
+	// decoders see the whole file even when it is a pipe.
+	unsigned char *in;
+	size_t in_pos;
+	size_t in_len;
+	int member_end;     // the decoder stopped at the end of a compressed stream
+	int at_end;         // no more output will follow
+	unsigned members;   // compressed streams decoded completely
+#ifdef CNF_HAVE_ZLIB
+	z_stream z;
+#endif
+#ifdef CNF_HAVE_LZMA
+	lzma_stream x;
+#endif
+#ifdef CNF_HAVE_BZIP2
+	bz_stream b;
+#endif
+	int decoder_ready;
+
+	// Tail of the last block after its final newline, moved to the next block
+	char *carry;
+	size_t carry_len;
+	size_t carry_cap;
+
+	pthread_t thread;
+	pthread_mutex_t lock;
+	pthread_cond_t filled;   // producer -> consumer
+	pthread_cond_t drained;  // consumer -> producer
+	StreamBlock slots[STREAM_SLOTS];
+	unsigned head;           // oldest filled slot
+	unsigned count;          // filled slots, including the one held by the consumer
+	int held;
+	int done;
+	int failed;
+	int stop;
+};
+
+static CnfFormat format_from_magic(const unsigned char *m, size_t n) {
+	if (n >= 2 && m[0] == 0x1f && m[1] == 0x8b) return CNF_FORMAT_GZIP;
+	if (n >= 6 && memcmp(m, "\xfd" "7zXZ\0", 6) == 0) return CNF_FORMAT_XZ;
+	if (n >= 3 && memcmp(m, "BZh", 3) == 0) return CNF_FORMAT_BZIP2;
+	return CNF_FORMAT_PLAIN;
+}
+
+int cnf_format_detect(const char *path) {
+	if (!path) return -1;
+	FILE *fp = fopen(path, "rb");
+	if (!fp) return -1;
+	unsigned char magic[STREAM_MAGIC_MAX];
+	size_t n = fread(magic, 1, sizeof(magic), fp);
+	int err = ferror(fp);
+	fclose(fp);
+	return err ? -1 : (int)format_from_magic(magic, n);
+}
+
+const char *cnf_format_name(CnfFormat format) {
+	switch (format) {
+	case CNF_FORMAT_GZIP: return "gzip";
+	case CNF_FORMAT_XZ: return "xz";
+	case CNF_FORMAT_BZIP2: return "bzip2";
+	case CNF_FORMAT_PLAIN:
+	default: return "plain";
+	}
+}
+
+int cnf_stream_needed(const char *path) {
+	if (!path) return 0;
+	if (strcmp(path, CNF_STDIN_PATH) == 0) return 1;
+	int format = cnf_format_detect(path);
+	return format > CNF_FORMAT_PLAIN;
+}
+
+#if defined(CNF_HAVE_ZLIB) || defined(CNF_HAVE_LZMA) || defined(CNF_HAVE_BZIP2)
+// Next chunk of raw input into s->in. Returns 0 (in_len == 0 at end of input) or -1.
+static int refill(CnfStream *s) {
+	s->in_pos = 0;
+	s->in_len = fread(s->in, 1, STREAM_READ_CHUNK, s->fp);
+	return (s->in_len == 0 && ferror(s->fp)) ? -1 : 0;
+}
+#endif
+
+// Decoders fill buf with up to cap bytes. They return the number of bytes
+// produced, 0 once the input is exhausted, -1 on a read error or corrupt data.
+
+static ptrdiff_t plain_decode(CnfStream *s, char *buf, size_t cap) {
+	if (s->in_pos < s->in_len) {
+		size_t n = s->in_len - s->in_pos;
+		if (n > cap) n = cap;
+		memcpy(buf, s->in + s->in_pos, n);
+		s->in_pos += n;
+		return (ptrdiff_t)n;
+	}
+	size_t n = fread(buf, 1, cap, s->fp);
+	if (n == 0 && ferror(s->fp)) return -1;
+	return (ptrdiff_t)n;
+}
+
+#ifdef CNF_HAVE_ZLIB
+static int gzip_init(CnfStream *s) {
+	memset(&s->z, 0, sizeof(s->z));
+	// 15 + 32: largest window, gzip or zlib header detected automatically
+	if (inflateInit2(&s->z, 15 + 32) != Z_OK) return -1;
+	s->z.next_in = s->in;
+	s->z.avail_in = (uInt)s->in_len;
+	return 0;
+}
+
+static ptrdiff_t gzip_decode(CnfStream *s, char *buf, size_t cap) {
+	z_stream *z = &s->z;
+	z->next_out = (Bytef *)buf;
+	z->avail_out = (uInt)cap;
+	while (z->avail_out > 0) {
+		if (z->avail_in == 0) {
+			if (refill(s) != 0) return -1;
+			if (s->in_len == 0) {
+				// Truncated member
+				if (s->members == 0 || z->total_out != 0) return -1;
+				s->at_end = 1;
+				break;
+			}
+			z->next_in = s->in;
+			z->avail_in = (uInt)s->in_len;
+		}
+		s->member_end = 0;
+		int r = inflate(z, Z_NO_FLUSH);
+		if (r == Z_STREAM_END) {
+			// Concatenated members (as written by pigz or cat a.gz b.gz)
+			s->member_end = 1;
+			s->members++;
+			if (inflateReset(z) != Z_OK) return -1;
+		} else if (r != Z_OK) {
+			// inflateReset cleared total_out, so nothing came out of this "member"
+			if (s->members == 0 || z->total_out != 0) return -1;
+			// Trailing garbage after the last member is ignored, as gzip does
+			s->at_end = 1;
+			break;
+		}
+	}
+	return (ptrdiff_t)(cap - z->avail_out);
+}
+#endif
+
+#ifdef CNF_HAVE_LZMA
+static int xz_init(CnfStream *s) {
+	lzma_stream init = LZMA_STREAM_INIT;
+	s->x = init;
+	if (lzma_stream_decoder(&s->x, UINT64_MAX, LZMA_CONCATENATED) != LZMA_OK) return -1;
+	s->x.next_in = s->in;
+	s->x.avail_in = s->in_len;
+	return 0;
+}
+
+static ptrdiff_t xz_decode(CnfStream *s, char *buf, size_t cap) {
+	lzma_stream *x = &s->x;
+	x->next_out = (uint8_t *)buf;
+	x->avail_out = cap;
+	lzma_action action = LZMA_RUN;
+	while (x->avail_out > 0) {
+		if (x->avail_in == 0 && action == LZMA_RUN) {
+			if (refill(s) != 0) return -1;
+			x->next_in = s->in;
+			x->avail_in = s->in_len;
+			// LZMA_CONCATENATED needs FINISH to know no further stream follows
+			if (s->in_len == 0) action = LZMA_FINISH;
+		}
+		lzma_ret r = lzma_code(x, action);
+		if (r == LZMA_STREAM_END) {
+			s->at_end = 1;
+			break;
+		}
+		if (r != LZMA_OK) return -1;
+	}
+	return (ptrdiff_t)(cap - x->avail_out);
+}
+#endif
+
+#ifdef CNF_HAVE_BZIP2
+static int bzip2_init(CnfStream *s) {
+	memset(&s->b, 0, sizeof(s->b));
+	if (BZ2_bzDecompressInit(&s->b, 0, 0) != BZ_OK) return -1;
+	s->b.next_in = (char *)s->in;
+	s->b.avail_in = (unsigned)s->in_len;
+	return 0;
+}
+
+static ptrdiff_t bzip2_decode(CnfStream *s, char *buf, size_t cap) {
+	bz_stream *b = &s->b;
+	b->next_out = buf;
+	b->avail_out = (unsigned)cap;
+	while (b->avail_out > 0) {
+		if (b->avail_in == 0) {
+			if (refill(s) != 0) return -1;
+			if (s->in_len == 0) {
+				if (!s->member_end) return -1;
+				s->at_end = 1;
+				break;
+			}
+			b->next_in = (char *)s->in;
+			b->avail_in = (unsigned)s->in_len;
+		}
+		if (s->member_end) {
+			// Another stream follows (pbzip2 writes one per block group)
+			bz_stream next = *b;
+			BZ2_bzDecompressEnd(b);
+			memset(b, 0, sizeof(*b));
+			if (BZ2_bzDecompressInit(b, 0, 0) != BZ_OK) { s->decoder_ready = 0; return -1; }
+			b->next_in = next.next_in;
+			b->avail_in = next.avail_in;
+			b->next_out = next.next_out;
+			b->avail_out = next.avail_out;
+			s->member_end = 0;
+			continue;
+		}
+		int r = BZ2_bzDecompress(b);
+		if (r == BZ_STREAM_END) {
+			s->member_end = 1;
+			s->members++;
+		} else if (r == BZ_DATA_ERROR_MAGIC && s->members > 0) {
+			// Trailing garbage after the last stream is ignored, as bzip2 does
+			s->at_end = 1;
+			break;
+		} else if (r != BZ_OK) {
+			return -1;
+		}
+	}
+	return (ptrdiff_t)(cap - b->avail_out);
+}
+#endif
+
+static int decoder_init(CnfStream *s) {
+	switch (s->format) {
+	case CNF_FORMAT_PLAIN: return 0;
+#ifdef CNF_HAVE_ZLIB
+	case CNF_FORMAT_GZIP: return gzip_init(s);
+#endif
+#ifdef CNF_HAVE_LZMA
+	case CNF_FORMAT_XZ: return xz_init(s);
+#endif
+#ifdef CNF_HAVE_BZIP2
+	case CNF_FORMAT_BZIP2: return bzip2_init(s);
+#endif
+	default: return -1; // decoder not compiled in
+	}
+}
+
+static ptrdiff_t decode(CnfStream *s, char *buf, size_t cap) {
+	if (s->at_end) return 0;
+	switch (s->format) {
+#ifdef CNF_HAVE_ZLIB
+	case CNF_FORMAT_GZIP: return gzip_decode(s, buf, cap);
+#endif
+#ifdef CNF_HAVE_LZMA
+	case CNF_FORMAT_XZ: return xz_decode(s, buf, cap);
+#endif
+#ifdef CNF_HAVE_BZIP2
+	case CNF_FORMAT_BZIP2: return bzip2_decode(s, buf, cap);
+#endif
+	default: return plain_decode(s, buf, cap);
+	}
+}
+
+static void decoder_end(CnfStream *s) {
+	if (!s->decoder_ready) return;
+	switch (s->format) {
+#ifdef CNF_HAVE_ZLIB
+	case CNF_FORMAT_GZIP: inflateEnd(&s->z); break;
+#endif
+#ifdef CNF_HAVE_LZMA
+	case CNF_FORMAT_XZ: lzma_end(&s->x); break;
+#endif
+#ifdef CNF_HAVE_BZIP2
+	case CNF_FORMAT_BZIP2: BZ2_bzDecompressEnd(&s->b); break;
+#endif
+	default: break;
+	}
+	s->decoder_ready = 0;
+}
+
+static int grow_block(StreamBlock *blk, size_t need) {
+	if (blk->cap >= need) return 0;
+	size_t cap = blk->cap ? blk->cap : STREAM_BLOCK;
+	while (cap < need) cap *= 2;
+	char *data = (char *)realloc(blk->data, cap);
+	if (!data) return -1;
+	blk->data = data;
+	blk->cap = cap;
+	return 0;
+}
+
+// Decode one block ending at a line boundary into blk. Returns 0, or -1.
+// Sets *eof once the input is exhausted.
+static int fill_block(CnfStream *s, StreamBlock *blk, int *eof) {
+	if (grow_block(blk, s->carry_len > STREAM_BLOCK / 2 ? s->carry_len * 2 : STREAM_BLOCK) != 0) return -1;
+	if (s->carry_len) memcpy(blk->data, s->carry, s->carry_len);
+	size_t len = s->carry_len;
+	s->carry_len = 0;
+	for (;;) {
+		while (len < blk->cap) {
+			ptrdiff_t n = decode(s, blk->data + len, blk->cap - len);
+			if (n < 0) return -1;
+			if (n == 0) { *eof = 1; break; }
+			len += (size_t)n;
+		}
+		if (*eof) break;
+		size_t cut = len;
+		while (cut > 0 && blk->data[cut - 1] != '\n') cut--;
+		if (cut > 0) {
+			size_t rest = len - cut;
+			if (rest > s->carry_cap) {
+				char *c = (char *)realloc(s->carry, rest);
+				if (!c) return -1;
+				s->carry = c;
+				s->carry_cap = rest;
+			}
+			memcpy(s->carry, blk->data + cut, rest);
+			s->carry_len = rest;
+			len = cut;
+			break;
+		}
+		// A single line longer than the block: keep reading
+		if (grow_block(blk, blk->cap * 2) != 0) return -1;
+	}
+	blk->len = len;
+	return 0;
+}
+
+static void *stream_producer(void *arg) {
+	CnfStream *s = (CnfStream *)arg;
+	int eof = 0, failed = 0;
+	while (!eof && !failed) {
+		pthread_mutex_lock(&s->lock);
+		while (s->count == STREAM_SLOTS && !s->stop) pthread_cond_wait(&s->drained, &s->lock);
+		int stop = s->stop;
+		StreamBlock *blk = &s->slots[(s->head + s->count) % STREAM_SLOTS];
+		pthread_mutex_unlock(&s->lock);
+		if (stop) break;
+		// The slot is outside [head, head + count), so the consumer leaves it alone
+		if (fill_block(s, blk, &eof) != 0) failed = 1;
+		pthread_mutex_lock(&s->lock);
+		if (!failed && blk->len > 0) {
+			s->count++;
+			pthread_cond_signal(&s->filled);
+		}
+		pthread_mutex_unlock(&s->lock);
+	}
+	pthread_mutex_lock(&s->lock);
+	s->done = 1;
+	s->failed = failed;
+	pthread_cond_signal(&s->filled);
+	pthread_mutex_unlock(&s->lock);
+	return NULL;
+}
+
+CnfStream *cnf_stream_open(const char *path) {
+	if (!path) return NULL;
+	CnfStream *s = (CnfStream *)calloc(1, sizeof(CnfStream));
+	if (!s) return NULL;
+	if (strcmp(path, CNF_STDIN_PATH) == 0) {
+		s->fp = stdin;
+#ifdef _WIN32
+		_setmode(_fileno(stdin), _O_BINARY);
+#endif
+	} else {
+		s->fp = fopen(path, "rb");
+		s->owns_fp = 1;
+	}
+	s->in = (unsigned char *)malloc(STREAM_READ_CHUNK);
+	if (!s->fp || !s->in) goto fail;
+	s->in_len = fread(s->in, 1, STREAM_MAGIC_MAX, s->fp);
+	if (ferror(s->fp)) goto fail;
+	s->format = format_from_magic(s->in, s->in_len);
+	if (decoder_init(s) != 0) goto fail;
+	s->decoder_ready = 1;
+	pthread_mutex_init(&s->lock, NULL);
+	pthread_cond_init(&s->filled, NULL);
+	pthread_cond_init(&s->drained, NULL);
+	if (pthread_create(&s->thread, NULL, stream_producer, s) != 0) {
+		pthread_cond_destroy(&s->drained);
+		pthread_cond_destroy(&s->filled);
+		pthread_mutex_destroy(&s->lock);
+		goto fail;
+	}
+	return s;
+fail:
+	decoder_end(s);
+	if (s->fp && s->owns_fp) fclose(s->fp);
+	free(s->in);
+	free(s);
+	return NULL;
+}
+
+ptrdiff_t cnf_stream_next(CnfStream *s, const char **data) {
+	if (!s || !data) return -1;
+	pthread_mutex_lock(&s->lock);
+	if (s->held) {
+		s->head = (s->head + 1) % STREAM_SLOTS;
+		s->count--;
+		s->held = 0;
+		pthread_cond_signal(&s->drained);
+	}
+	while (s->count == 0 && !s->done) pthread_cond_wait(&s->filled, &s->lock);
+	ptrdiff_t n;
+	if (s->count == 0) {
+		n = s->failed ? -1 : 0;
+		*data = NULL;
+	} else {
+		s->held = 1;
+		*data = s->slots[s->head].data;
+		n = (ptrdiff_t)s->slots[s->head].len;
+	}
+	pthread_mutex_unlock(&s->lock);
+	return n;
+}
+
+CnfFormat cnf_stream_format(const CnfStream *s) {
+	return s ? s->format : CNF_FORMAT_PLAIN;
+}
+
+void cnf_stream_close(CnfStream *s) {
+	if (!s) return;
+	pthread_mutex_lock(&s->lock);
+	s->stop = 1;
+	pthread_cond_signal(&s->drained);
+	pthread_mutex_unlock(&s->lock);
+	pthread_join(s->thread, NULL);
+	pthread_cond_destroy(&s->drained);
+	pthread_cond_destroy(&s->filled);
+	pthread_mutex_destroy(&s->lock);
+	decoder_end(s);
+	for (int i = 0; i < STREAM_SLOTS; ++i) free(s->slots[i].data);
+	free(s->carry);
+	free(s->in);
+	if (s->owns_fp) fclose(s->fp);
+	free(s);
+}
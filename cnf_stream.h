@@ -0,0 +1,45 @@
+// cnf_stream.h - Block-wise DIMACS input from stdin and compressed files
+#ifndef SAT_CNF_STREAM_H
+#define SAT_CNF_STREAM_H
+
+#include <stddef.h>
+
+// Input encodings, recognized by their magic bytes
+typedef enum CnfFormat {
+	CNF_FORMAT_PLAIN = 0,
+	CNF_FORMAT_GZIP = 1,
+	CNF_FORMAT_XZ = 2,
+	CNF_FORMAT_BZIP2 = 3
+} CnfFormat;
+
+// Path that selects standard input
+#define CNF_STDIN_PATH "-"
+
+// Format of the file at path. Returns -1 if it cannot be read.
+int cnf_format_detect(const char *path);
+
+const char *cnf_format_name(CnfFormat format);
+
+// 1 if path has to be read through a CnfStream: stdin or a compressed file.
+// Plain files are better served by cnf_input_open.
+int cnf_stream_needed(const char *path);
+
+// Input read (and decompressed) on a background thread while the caller
+// parses earlier blocks.
+typedef struct CnfStream CnfStream;
+
+// Open path, or stdin for CNF_STDIN_PATH. Returns NULL on failure or when
+// the format's decoder was not compiled in.
+CnfStream *cnf_stream_open(const char *path);
+
+// Next block of text. Blocks end right after a newline (only the last one
+// may not), so no line is ever split across blocks. The block stays valid
+// until the next call. Returns its length, 0 at the end of the input, -1 on
+// a read or decode error.
+ptrdiff_t cnf_stream_next(CnfStream *s, const char **data);
+
+CnfFormat cnf_stream_format(const CnfStream *s);
+
+void cnf_stream_close(CnfStream *s);
+
+#endif // SAT_CNF_STREAM_H
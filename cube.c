@@ -0,0 +1,326 @@
+#include "cube.h"
+#include "parallel.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Cubes as DIMACS literals stored back to back
+typedef struct CubeList {
+	int *lits;
+	size_t size;
+	size_t capacity;
+	size_t *start;      // cube i is lits[start[i] .. start[i + 1])
+	int *depth;         // branching literals in cube i
+	int num;
+	int cap;
+} CubeList;
+
+// Per-worker queue of cube indices: the owner pops from the back, thieves
+// take from the front, so a worker keeps neighbouring cubes (sharing most of
+// their literals, and so most of its learned clauses) to itself
+typedef struct CubeQueue {
+	int *items;
+	int top;
+	int bottom;
+	pthread_mutex_t lock;
+} CubeQueue;
+
+typedef struct CubeShared {
+	const OptCNF *cnf;
+	const CubeList *cubes;
+	CubeQueue *queues;
+	int threads;
+	double start_ms;
+	long timeout_ms;
+	volatile int stop;
+	pthread_mutex_t lock;
+	int result;         // 1 SAT, 0 the formula is UNSAT, -2 error, -1 still open
+	int sat_cube;
+	int solved;
+	Assignment model;
+	double *cube_ms;
+} CubeShared;
+
+typedef struct CubeWorker {
+	CubeShared *shared;
+	int index;
+	SolverOptions opts;
+	CubeWorkerStats st;
+} CubeWorker;
+
+void cube_default_options(CubeOptions *opts) {
+	if (!opts) return;
+	opts->threads = 0;
+	opts->max_cubes = 0;
+	opts->max_depth = 40;
+	opts->candidates = 100;
+	opts->lookahead_ms = 1000;
+}
+
+void cube_stats_free(CubeStats *stats) {
+	if (!stats) return;
+	free(stats->cube_ms);
+	stats->cube_ms = NULL;
+}
+
+static void cube_list_free(CubeList *l) {
+	free(l->lits);
+	free(l->start);
+	free(l->depth);
+	memset(l, 0, sizeof(*l));
+}
+
+// Append the cube prefix[0..n) + extra[0..m) (+ last if non-zero)
+static int cube_push(CubeList *l, const int *prefix, int n, const int *extra, int m, int last, int depth) {
+	size_t need = l->size + (size_t)n + (size_t)m + 1;
+	if (need > l->capacity) {
+		size_t cap = l->capacity ? l->capacity * 2 : 1024;
+		while (cap < need) cap *= 2;
+		int *lits = (int *)realloc(l->lits, cap * sizeof(int));
+		if (!lits) return -1;
+		l->lits = lits;
+		l->capacity = cap;
+	}
+	if (l->num + 2 > l->cap) {
+		int cap = l->cap ? l->cap * 2 : 64;
+		size_t *start = (size_t *)realloc(l->start, (size_t)cap * sizeof(size_t));
+		if (!start) return -1;
+		l->start = start;
+		int *dep = (int *)realloc(l->depth, (size_t)cap * sizeof(int));
+		if (!dep) return -1;
+		l->depth = dep;
+		l->cap = cap;
+	}
+	if (l->num == 0) l->start[0] = 0;
+	if (n) memcpy(l->lits + l->size, prefix, (size_t)n * sizeof(int));
+	if (m) memcpy(l->lits + l->size + n, extra, (size_t)m * sizeof(int));
+	l->size += (size_t)n + (size_t)m;
+	if (last) l->lits[l->size++] = last;
+	l->depth[l->num] = depth;
+	l->start[++l->num] = l->size;
+	return 0;
+}
+
+// Breadth-first lookahead splitting into at most 'target' leaves.
+// Returns 1, or 0 if every branch was refuted, -2 on error.
+static int split_cubes(const OptCNF *cnf, const SolverOptions *opts, const CubeOptions *co, int target,
+	CubeList *leaves, CubeStats *st) {
+	SolverOptions lopts = *opts;
+	lopts.gauss = 0;
+	lopts.stop = NULL;
+	lopts.exchange = NULL;
+	Solver *look = solver_new_opt(cnf, &lopts);
+	int *implied = (int *)malloc((size_t)(cnf->num_variables + 1) * sizeof(int));
+	int *cube = (int *)malloc((size_t)(cnf->num_variables + 1) * sizeof(int));
+	CubeList open;
+	memset(&open, 0, sizeof(open));
+	int r = look && implied && cube && cube_push(&open, NULL, 0, NULL, 0, 0, 0) == 0 ? 1 : -2;
+	double start = wall_ms();
+	for (int i = 0; r == 1 && i < open.num; ++i) {
+		// Copied out: 'open' moves when children are appended
+		int n = (int)(open.start[i + 1] - open.start[i]);
+		memcpy(cube, open.lits + open.start[i], (size_t)n * sizeof(int));
+		int depth = open.depth[i];
+		int pending = open.num - i - 1;
+		int out_of_time = co->lookahead_ms > 0 && wall_ms() - start > (double)co->lookahead_ms;
+		if (leaves->num + pending + 1 >= target || depth >= co->max_depth || out_of_time) {
+			if (cube_push(leaves, cube, n, NULL, 0, 0, depth) != 0) r = -2;
+			continue;
+		}
+		int num_implied = 0, var = 0;
+		int la = solver_lookahead(look, cube, n, co->candidates, implied, &num_implied, &var);
+		if (la == -2) { r = -2; break; }
+		if (la == 0) {
+			st->refuted++;
+			continue;
+		}
+		if (var == 0) {
+			if (cube_push(leaves, cube, n, implied, num_implied, 0, depth) != 0) r = -2;
+			continue;
+		}
+		if (cube_push(&open, cube, n, implied, num_implied, var, depth + 1) != 0 ||
+			cube_push(&open, cube, n, implied, num_implied, -var, depth + 1) != 0) {
+			r = -2;
+		}
+	}
+	cube_list_free(&open);
+	free(cube);
+	free(implied);
+	solver_free(look);
+	if (r == 1 && leaves->num == 0) r = 0;
+	return r;
+}
+
+// Next cube for worker w: its own queue first, then the other queues
+static int take_cube(CubeShared *sh, int w, unsigned long *steals) {
+	int c = -1;
+	CubeQueue *q = &sh->queues[w];
+	pthread_mutex_lock(&q->lock);
+	if (q->top < q->bottom) c = q->items[--q->bottom];
+	pthread_mutex_unlock(&q->lock);
+	for (int k = 1; c < 0 && k < sh->threads; ++k) {
+		CubeQueue *v = &sh->queues[(w + k) % sh->threads];
+		pthread_mutex_lock(&v->lock);
+		if (v->top < v->bottom) c = v->items[v->top++];
+		pthread_mutex_unlock(&v->lock);
+		if (c >= 0) (*steals)++;
+	}
+	return c;
+}
+
+// Record the end of the search: the first answer wins and stops everyone
+static void cube_finish(CubeShared *sh, int result, int cube, Assignment *model) {
+	pthread_mutex_lock(&sh->lock);
+	if (sh->result == -1) {
+		sh->result = result;
+		sh->sat_cube = cube;
+		if (result == 1) sh->model = *model;
+		else if (model) free_assignment(model);
+		sh->stop = 1;
+	} else if (model) {
+		free_assignment(model);
+	}
+	pthread_mutex_unlock(&sh->lock);
+}
+
+static void *cube_worker(void *arg) {
+	CubeWorker *w = (CubeWorker *)arg;
+	CubeShared *sh = w->shared;
+	Solver *s = solver_new_opt(sh->cnf, &w->opts);
+	if (!s) {
+		cube_finish(sh, -2, -1, NULL);
+		return NULL;
+	}
+	while (!sh->stop) {
+		int c = take_cube(sh, w->index, &w->st.steals);
+		if (c < 0) break;
+		long left = 0;
+		if (sh->timeout_ms > 0) {
+			left = sh->timeout_ms - (long)(wall_ms() - sh->start_ms);
+			if (left <= 0) break;
+		}
+		const CubeList *cl = sh->cubes;
+		Assignment model;
+		double ms = 0.0;
+		int r = solver_solve(s, cl->lits + cl->start[c], (int)(cl->start[c + 1] - cl->start[c]), &model, left, &ms);
+		w->st.busy_ms += ms;
+		if (r == -1) break;
+		w->st.cubes++;
+		pthread_mutex_lock(&sh->lock);
+		sh->cube_ms[c] = ms;
+		if (r >= 0) sh->solved++;
+		pthread_mutex_unlock(&sh->lock);
+		if (r == 1) cube_finish(sh, 1, c, &model);
+		else if (r == -2) cube_finish(sh, -2, c, NULL);
+		else if (solver_failed_assumptions(s, NULL) == 0) cube_finish(sh, 0, c, NULL);
+	}
+	solver_get_stats(s, &w->st.stats);
+	solver_free(s);
+	return NULL;
+}
+
+int cube_solve(const OptCNF *cnf, Assignment *model, const SolverOptions *opts, const CubeOptions *copts,
+	const ExchangeOptions *share, long timeout_ms, CubeStats *stats, double *out_time_ms) {
+	CubeStats local;
+	if (!stats) stats = &local;
+	memset(stats, 0, sizeof(*stats));
+	stats->sat_cube = -1;
+	if (!cnf || !model) return -2;
+	double start = wall_ms();
+	SolverOptions defaults;
+	if (!opts) {
+		solver_default_options(&defaults);
+		opts = &defaults;
+	}
+	CubeOptions co;
+	if (copts) co = *copts;
+	else cube_default_options(&co);
+	int threads = co.threads > 0 ? co.threads : cpu_count();
+	if (threads > CUBE_MAX_THREADS) threads = CUBE_MAX_THREADS;
+	int target = co.max_cubes > 0 ? co.max_cubes : 16 * threads;
+	stats->threads = threads;
+
+	CubeList cubes;
+	memset(&cubes, 0, sizeof(cubes));
+	int res = split_cubes(cnf, opts, &co, target, &cubes, stats);
+	stats->lookahead_ms = wall_ms() - start;
+	stats->cubes = cubes.num;
+	if (res != 1) {
+		cube_list_free(&cubes);
+		if (out_time_ms) *out_time_ms = wall_ms() - start;
+		return res;
+	}
+
+	// Conquer: contiguous blocks of cubes per worker, stolen one at a time
+	CubeShared sh;
+	memset(&sh, 0, sizeof(sh));
+	sh.cnf = cnf;
+	sh.cubes = &cubes;
+	sh.threads = threads;
+	sh.start_ms = start;
+	sh.timeout_ms = timeout_ms;
+	sh.result = -1;
+	sh.sat_cube = -1;
+	ClauseExchange exchange;
+	int sharing = share && threads > 1;
+	CubeWorker *workers = (CubeWorker *)calloc((size_t)threads, sizeof(CubeWorker));
+	sh.queues = (CubeQueue *)calloc((size_t)threads, sizeof(CubeQueue));
+	sh.cube_ms = (double *)malloc((size_t)cubes.num * sizeof(double));
+	int *items = (int *)malloc((size_t)cubes.num * sizeof(int));
+	if (!workers || !sh.queues || !sh.cube_ms || !items || (sharing && exchange_init(&exchange, threads, share) != 0)) {
+		free(workers);
+		free(sh.queues);
+		free(sh.cube_ms);
+		free(items);
+		cube_list_free(&cubes);
+		return -2;
+	}
+	pthread_mutex_init(&sh.lock, NULL);
+	for (int c = 0; c < cubes.num; ++c) {
+		items[c] = c;
+		sh.cube_ms[c] = -1.0;
+	}
+	for (int t = 0; t < threads; ++t) {
+		CubeQueue *q = &sh.queues[t];
+		q->items = items;
+		q->top = (int)((long long)cubes.num * t / threads);
+		q->bottom = (int)((long long)cubes.num * (t + 1) / threads);
+		pthread_mutex_init(&q->lock, NULL);
+		workers[t].shared = &sh;
+		workers[t].index = t;
+		workers[t].opts = *opts;
+		workers[t].opts.stop = &sh.stop;
+		workers[t].opts.exchange = sharing ? &exchange : NULL;
+		workers[t].opts.exchange_id = t;
+	}
+	double conquer_start = wall_ms();
+	// Cubes queued for workers that never started are stolen by the others
+	int started = parallel_run(workers, sizeof(CubeWorker), threads, cube_worker, 0);
+	stats->conquer_ms = wall_ms() - conquer_start;
+
+	res = sh.result;
+	if (res == -1 && sh.solved == cubes.num) res = 0;
+	if (res == 1) *model = sh.model;
+	stats->solved = sh.solved;
+	stats->sat_cube = sh.sat_cube;
+	stats->cube_ms = sh.cube_ms;
+	stats->threads = started;
+	double max_busy = 0.0, sum_busy = 0.0;
+	for (int t = 0; t < started; ++t) {
+		stats->workers[t] = workers[t].st;
+		sum_busy += workers[t].st.busy_ms;
+		if (workers[t].st.busy_ms > max_busy) max_busy = workers[t].st.busy_ms;
+	}
+	stats->imbalance = sum_busy > 0.0 ? max_busy / (sum_busy / started) : 1.0;
+
+	for (int t = 0; t < threads; ++t) pthread_mutex_destroy(&sh.queues[t].lock);
+	pthread_mutex_destroy(&sh.lock);
+	if (sharing) exchange_free(&exchange);
+	free(items);
+	free(sh.queues);
+	free(workers);
+	cube_list_free(&cubes);
+	if (stats == &local) cube_stats_free(&local);
+	if (out_time_ms) *out_time_ms = wall_ms() - start;
+	return res;
+}
@@ -0,0 +1,50 @@
+// cube.h - cube-and-conquer: lookahead splitting, then the cubes on a thread pool
+#ifndef SAT_CUBE_H
+#define SAT_CUBE_H
+
+#include "solver.h"
+#include "exchange.h"
+
+#define CUBE_MAX_THREADS 64
+
+typedef struct CubeOptions {
+	int threads;        // conquer workers, 0 = one per CPU
+	int max_cubes;      // stop splitting at this many cubes, 0 = 16 per worker
+	int max_depth;      // longest cube built by splitting
+	int candidates;     // variables looked ahead per node, 0 = all free ones
+	long lookahead_ms;  // time budget of the splitting phase (<= 0: no limit)
+} CubeOptions;
+
+typedef struct CubeWorkerStats {
+	int cubes;              // cubes finished by this worker
+	unsigned long steals;   // cubes taken from other workers' queues
+	double busy_ms;         // time spent solving cubes
+	SolverStats stats;
+} CubeWorkerStats;
+
+typedef struct CubeStats {
+	int cubes;              // leaves handed to the workers
+	int refuted;            // nodes closed by the lookahead itself
+	int solved;             // cubes finished (refuted, or the satisfiable one)
+	int sat_cube;           // index of the satisfiable cube, -1 if none
+	double lookahead_ms;
+	double conquer_ms;
+	double *cube_ms;        // per cube, -1 if never finished; free with cube_stats_free
+	double imbalance;       // busiest worker's time over the mean (1.0 = balanced)
+	int threads;
+	CubeWorkerStats workers[CUBE_MAX_THREADS];
+} CubeStats;
+
+// Fill 'opts' with the defaults used by cube_solve
+void cube_default_options(CubeOptions *opts);
+
+// Split 'cnf' into cubes by lookahead and solve them on a work-stealing pool
+// of incremental solvers configured by 'opts' (may be NULL). With 'share'
+// (NULL = off) the workers exchange short learned clauses at restarts.
+// The first satisfiable cube stops every worker. Same contract as
+// cdcl_solve_opt; stats may be NULL.
+int cube_solve(const OptCNF *cnf, Assignment *model, const SolverOptions *opts, const CubeOptions *copts,
+	const ExchangeOptions *share, long timeout_ms, CubeStats *stats, double *out_time_ms);
+void cube_stats_free(CubeStats *stats);
+
+#endif // SAT_CUBE_H
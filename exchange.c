@@ -0,0 +1,117 @@
+#include "exchange.h"
+#include <stdlib.h>
+#include <string.h>
+
+void exchange_default_options(ExchangeOptions *opts) {
+	if (!opts) return;
+	opts->max_lbd = 3;
+	opts->max_size = 30;
+	opts->ring_bits = 16;
+}
+
+int exchange_init(ClauseExchange *x, int threads, const ExchangeOptions *opts) {
+	memset(x, 0, sizeof(*x));
+	if (threads <= 0) return -1;
+	if (opts) x->opts = *opts;
+	else exchange_default_options(&x->opts);
+	if (x->opts.max_size > EXCHANGE_MAX_SIZE) x->opts.max_size = EXCHANGE_MAX_SIZE;
+	// A ring must hold several of the longest clauses
+	if (x->opts.ring_bits < 10) x->opts.ring_bits = 10;
+	if (x->opts.ring_bits > 26) x->opts.ring_bits = 26;
+	size_t words = (size_t)1 << x->opts.ring_bits;
+	x->num_threads = threads;
+	x->mask = (uint64_t)words - 1;
+	x->rings = (ClauseRing *)calloc((size_t)threads, sizeof(ClauseRing));
+	x->cursor = (uint64_t *)calloc((size_t)threads * (size_t)threads, sizeof(uint64_t));
+	x->seen = (uint64_t *)calloc((size_t)threads * (size_t)threads, sizeof(uint64_t));
+	if (!x->rings || !x->cursor || !x->seen) {
+		exchange_free(x);
+		return -1;
+	}
+	for (int t = 0; t < threads; ++t) {
+		x->rings[t].words = (uint32_t *)calloc(words, sizeof(uint32_t));
+		if (!x->rings[t].words) {
+			exchange_free(x);
+			return -1;
+		}
+	}
+	return 0;
+}
+
+void exchange_free(ClauseExchange *x) {
+	if (!x) return;
+	if (x->rings) {
+		for (int t = 0; t < x->num_threads; ++t) free(x->rings[t].words);
+	}
+	free(x->rings);
+	free(x->cursor);
+	free(x->seen);
+	memset(x, 0, sizeof(*x));
+}
+
+int exchange_export(ClauseExchange *x, int id, const int *lits, int n, int lbd) {
+	if (n <= 0 || n > x->opts.max_size) return 0;
+	if (n > 2 && lbd > x->opts.max_lbd) return 0;
+	ClauseRing *r = &x->rings[id];
+	uint64_t h = r->head;
+	uint64_t end = h + (uint64_t)n + 1;
+	// Seqlock-style: claim, write, publish. Readers compare 'reserve' with the
+	// positions they copied to detect words overwritten under them.
+	__atomic_store_n(&r->reserve, end, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+	uint32_t hdr = (uint32_t)n | (uint32_t)(lbd > 0xFFFF ? 0xFFFF : lbd) << 16;
+	__atomic_store_n(&r->words[h & x->mask], hdr, __ATOMIC_RELAXED);
+	for (int i = 0; i < n; ++i) {
+		__atomic_store_n(&r->words[(h + 1 + (uint64_t)i) & x->mask], (uint32_t)lits[i], __ATOMIC_RELAXED);
+	}
+	__atomic_store_n(&r->clauses, r->clauses + 1, __ATOMIC_RELAXED);
+	__atomic_store_n(&r->head, end, __ATOMIC_RELEASE);
+	return 1;
+}
+
+int exchange_import(ClauseExchange *x, int id, ExchangeImportFn fn, void *arg, unsigned long *lost) {
+	int lits[EXCHANGE_MAX_SIZE];
+	uint64_t capacity = x->mask + 1;
+	for (int t = 0; t < x->num_threads; ++t) {
+		if (t == id) continue;
+		ClauseRing *r = &x->rings[t];
+		uint64_t *cursor = &x->cursor[(size_t)id * (size_t)x->num_threads + (size_t)t];
+		uint64_t *seen = &x->seen[(size_t)id * (size_t)x->num_threads + (size_t)t];
+		uint64_t head = __atomic_load_n(&r->head, __ATOMIC_ACQUIRE);
+		uint64_t c = *cursor;
+		while (c < head) {
+			int intact = head - c <= capacity;
+			int n = 0, lbd = 0;
+			if (intact) {
+				uint32_t hdr = __atomic_load_n(&r->words[c & x->mask], __ATOMIC_RELAXED);
+				n = (int)(hdr & 0xFFFF);
+				lbd = (int)(hdr >> 16);
+				if (n <= 0 || n > EXCHANGE_MAX_SIZE) n = 0;
+				for (int i = 0; i < n; ++i) {
+					lits[i] = (int)__atomic_load_n(&r->words[(c + 1 + (uint64_t)i) & x->mask], __ATOMIC_RELAXED);
+				}
+				__atomic_thread_fence(__ATOMIC_ACQUIRE);
+				uint64_t reserve = __atomic_load_n(&r->reserve, __ATOMIC_RELAXED);
+				intact = n > 0 && reserve - c <= capacity;
+			}
+			if (!intact) {
+				// The writer lapped us: skip to its current position
+				uint64_t total = __atomic_load_n(&r->clauses, __ATOMIC_RELAXED);
+				head = __atomic_load_n(&r->head, __ATOMIC_ACQUIRE);
+				if (lost && total > *seen) *lost += (unsigned long)(total - *seen);
+				*seen = total;
+				c = head;
+				break;
+			}
+			c += (uint64_t)n + 1;
+			(*seen)++;
+			int stop = fn(arg, lits, n, lbd);
+			if (stop) {
+				*cursor = c;
+				return stop;
+			}
+		}
+		*cursor = c;
+	}
+	return 0;
+}
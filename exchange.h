@@ -0,0 +1,57 @@
+// exchange.h - learned clauses passed between portfolio threads
+#ifndef SAT_EXCHANGE_H
+#define SAT_EXCHANGE_H
+
+#include <stdint.h>
+
+// Longest clause that can be shared
+#define EXCHANGE_MAX_SIZE 128
+
+typedef struct ExchangeOptions {
+	int max_lbd;        // clauses of 3+ literals are shared if LBD <= max_lbd ...
+	int max_size;       // ... and size <= max_size; units and binaries always are
+	int ring_bits;      // each thread's ring holds 2^ring_bits 32-bit words
+} ExchangeOptions;
+
+// One ring per thread, written only by its owner: clauses are stored as a
+// header word (size | lbd << 16) followed by packed literals. 'reserve' is
+// advanced before the words are written and 'head' after, so a reader can
+// tell whether the words it copied were overwritten meanwhile.
+typedef struct ClauseRing {
+	uint32_t *words;
+	uint64_t head;          // words published
+	uint64_t reserve;       // words claimed by the writer
+	uint64_t clauses;       // clauses published
+	char pad[64];           // keep rings' counters off each other's cache line
+} ClauseRing;
+
+typedef struct ClauseExchange {
+	int num_threads;
+	ExchangeOptions opts;
+	uint64_t mask;          // ring words - 1
+	ClauseRing *rings;
+	uint64_t *cursor;       // [reader * num_threads + ring]: next word to read
+	uint64_t *seen;         // [reader * num_threads + ring]: clauses read or lost
+} ClauseExchange;
+
+// Called for every clause another thread exported; a non-zero return stops
+// the import and is handed back by exchange_import
+typedef int (*ExchangeImportFn)(void *arg, const int *lits, int n, int lbd);
+
+// Fill 'opts' with the defaults used by exchange_init
+void exchange_default_options(ExchangeOptions *opts);
+
+// opts may be NULL. Returns 0 on success, -1 on allocation failure.
+int exchange_init(ClauseExchange *x, int threads, const ExchangeOptions *opts);
+void exchange_free(ClauseExchange *x);
+
+// Publish a learned clause of thread 'id' if it passes the limits; never
+// blocks. Returns 1 if exported, 0 if filtered out.
+int exchange_export(ClauseExchange *x, int id, const int *lits, int n, int lbd);
+
+// Hand thread 'id' every clause the other threads published since its last
+// call. Clauses overwritten before they were read are added to *lost.
+// Returns 0, or the first non-zero value returned by fn.
+int exchange_import(ClauseExchange *x, int id, ExchangeImportFn fn, void *arg, unsigned long *lost);
+
+#endif // SAT_EXCHANGE_H
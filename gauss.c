@@ -0,0 +1,456 @@
+#include "gauss.h"
+#include "literal.h"
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define GAUSS_HAVE_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
+// Matrices above this many 64-bit words are not built
+#ifndef GAUSS_MAX_WORDS
+#define GAUSS_MAX_WORDS (1u << 22)
+#endif
+
+// ---- XOR detection ----
+
+typedef struct XorCand {
+	int vars[XOR_MAX_SIZE]; // sorted
+	uint8_t size;
+	uint8_t mask;           // bit i: the literal of vars[i] is negative
+} XorCand;
+
+static int cmp_xor_cand(const void *a, const void *b) {
+	const XorCand *x = (const XorCand *)a;
+	const XorCand *y = (const XorCand *)b;
+	if (x->size != y->size) return x->size < y->size ? -1 : 1;
+	for (int i = 0; i < x->size; ++i) {
+		if (x->vars[i] != y->vars[i]) return x->vars[i] < y->vars[i] ? -1 : 1;
+	}
+	return (x->mask > y->mask) - (x->mask < y->mask);
+}
+
+static int same_vars(const XorCand *x, const XorCand *y) {
+	if (x->size != y->size) return 0;
+	for (int i = 0; i < x->size; ++i) {
+		if (x->vars[i] != y->vars[i]) return 0;
+	}
+	return 1;
+}
+
+static int xor_push(XorList *x, int v) {
+	if (x->size == x->capacity) {
+		size_t new_cap = x->capacity ? x->capacity * 2 : 256;
+		int *arr = (int *)realloc(x->data, new_cap * sizeof(int));
+		if (!arr) return -1;
+		x->data = arr;
+		x->capacity = new_cap;
+	}
+	x->data[x->size++] = v;
+	return 0;
+}
+
+int xor_detect(const ClauseArena *arena, const ClauseRef *refs, size_t count, XorList *out) {
+	memset(out, 0, sizeof(*out));
+	XorCand *cand = (XorCand *)malloc((count ? count : 1) * sizeof(XorCand));
+	if (!cand) return -1;
+	size_t nc = 0;
+	for (size_t i = 0; i < count; ++i) {
+		const ArenaClause *c = arena_clause(arena, refs[i]);
+		if (c->size < 2 || c->size > XOR_MAX_SIZE || (c->flags & ARENA_CLAUSE_DELETED)) continue;
+		XorCand *x = &cand[nc++];
+		x->size = (uint8_t)c->size;
+		int lits[XOR_MAX_SIZE];
+		// Insertion sort by variable; literals of a clause have distinct variables
+		for (uint32_t j = 0; j < c->size; ++j) {
+			int l = c->lits[j];
+			int k = (int)j;
+			while (k > 0 && lit_var(lits[k - 1]) > lit_var(l)) { lits[k] = lits[k - 1]; --k; }
+			lits[k] = l;
+		}
+		x->mask = 0;
+		for (uint32_t j = 0; j < c->size; ++j) {
+			x->vars[j] = lit_var(lits[j]);
+			if (lit_neg(lits[j])) x->mask |= (uint8_t)(1u << j);
+		}
+	}
+	qsort(cand, nc, sizeof(XorCand), cmp_xor_cand);
+
+	// A clause with sign mask m excludes the assignment m; all masks of one
+	// parity excluded leaves the assignments of the other parity
+	uint32_t parity_masks[XOR_MAX_SIZE + 1][2];
+	for (int k = 1; k <= XOR_MAX_SIZE; ++k) {
+		parity_masks[k][0] = parity_masks[k][1] = 0;
+		for (uint32_t m = 0; m < (1u << k); ++m) parity_masks[k][__builtin_popcount(m) & 1] |= 1u << m;
+	}
+	for (size_t i = 0; i < nc;) {
+		size_t j = i;
+		uint32_t seen = 0;
+		while (j < nc && same_vars(&cand[i], &cand[j])) seen |= 1u << cand[j++].mask;
+		int k = cand[i].size;
+		for (int q = 0; q < 2; ++q) {
+			if ((seen & parity_masks[k][q]) != parity_masks[k][q]) continue;
+			if (xor_push(out, k) != 0 || xor_push(out, q ^ 1) != 0) { free(cand); return -1; }
+			for (int t = 0; t < k; ++t) {
+				if (xor_push(out, cand[i].vars[t]) != 0) { free(cand); return -1; }
+			}
+			out->num++;
+		}
+		i = j;
+	}
+	free(cand);
+	return (int)out->num;
+}
+
+void xor_list_free(XorList *x) {
+	if (!x) return;
+	free(x->data);
+	memset(x, 0, sizeof(*x));
+}
+
+// ---- Row kernels ----
+
+static void row_xor_scalar(uint64_t *dst, const uint64_t *src, int words) {
+	for (int i = 0; i < words; ++i) dst[i] ^= src[i];
+}
+
+#ifdef GAUSS_HAVE_X86_SIMD
+__attribute__((target("avx2")))
+static void row_xor_avx2(uint64_t *dst, const uint64_t *src, int words) {
+	int i = 0;
+	for (; i + 4 <= words; i += 4) {
+		__m256i a = _mm256_loadu_si256((const __m256i *)(dst + i));
+		__m256i b = _mm256_loadu_si256((const __m256i *)(src + i));
+		_mm256_storeu_si256((__m256i *)(dst + i), _mm256_xor_si256(a, b));
+	}
+	for (; i < words; ++i) dst[i] ^= src[i];
+}
+#endif
+
+static GaussRowXorFn select_row_xor(void) {
+#ifdef GAUSS_HAVE_X86_SIMD
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2")) return row_xor_avx2;
+#endif
+	return row_xor_scalar;
+}
+
+const char *gauss_kernel_name(const GaussMatrix *g) {
+#ifdef GAUSS_HAVE_X86_SIMD
+	if (g->row_xor == row_xor_avx2) return "avx2";
+#endif
+	(void)g;
+	return "scalar";
+}
+
+// ---- Matrix ----
+
+static inline uint64_t *row_at(const GaussMatrix *g, int r) {
+	return g->rows + (size_t)r * (size_t)g->words;
+}
+
+static inline int test_bit(const uint64_t *bits, int c) {
+	return (int)((bits[c >> 6] >> (c & 63)) & 1);
+}
+
+static inline void set_bit(uint64_t *bits, int c) { bits[c >> 6] |= 1ULL << (c & 63); }
+static inline void clear_bit(uint64_t *bits, int c) { bits[c >> 6] &= ~(1ULL << (c & 63)); }
+
+static int rowlist_push(GaussRowList *l, int r) {
+	if (l->size == l->capacity) {
+		int new_cap = l->capacity ? l->capacity * 2 : 4;
+		int *arr = (int *)realloc(l->data, (size_t)new_cap * sizeof(int));
+		if (!arr) return -1;
+		l->data = arr;
+		l->capacity = new_cap;
+	}
+	l->data[l->size++] = r;
+	return 0;
+}
+
+static void push_work(GaussMatrix *g, int r) {
+	if (g->in_work[r]) return;
+	g->in_work[r] = 1;
+	g->work[g->work_size++] = r;
+}
+
+static int out_push(GaussMatrix *g, int x) {
+	if (g->out_size == g->out_cap) {
+		size_t new_cap = g->out_cap ? g->out_cap * 2 : 256;
+		int *arr = (int *)realloc(g->out, new_cap * sizeof(int));
+		if (!arr) return -1;
+		g->out = arr;
+		g->out_cap = new_cap;
+	}
+	g->out[g->out_size++] = x;
+	return 0;
+}
+
+// First unassigned non-basic column of a row, -1 if none
+static int find_free(const GaussMatrix *g, const uint64_t *row) {
+	for (int i = 0; i < g->words; ++i) {
+		uint64_t m = row[i] & ~g->assigned[i] & ~g->basic_mask[i];
+		if (m) return i * 64 + __builtin_ctzll(m);
+	}
+	return -1;
+}
+
+// Parity of the true columns of a row
+static int row_parity(const GaussMatrix *g, const uint64_t *row) {
+	uint64_t p = 0;
+	for (int i = 0; i < g->words; ++i) p ^= row[i] & g->value[i];
+	return __builtin_popcountll(p) & 1;
+}
+
+// Append the clause of row r that the current assignment falsifies, with
+// column 'implied' (if >= 0) as the positive first literal
+static int emit_row_clause(GaussMatrix *g, int r, int implied, int implied_value) {
+	const uint64_t *row = row_at(g, r);
+	size_t start = g->out_size;
+	if (out_push(g, 0) != 0) return -1;
+	if (implied >= 0 && out_push(g, mk_lit(g->var_of_col[implied], !implied_value)) != 0) return -1;
+	for (int i = 0; i < g->words; ++i) {
+		uint64_t m = row[i];
+		while (m) {
+			int c = i * 64 + __builtin_ctzll(m);
+			m &= m - 1;
+			if (c == implied) continue;
+			if (out_push(g, mk_lit(g->var_of_col[c], test_bit(g->value, c))) != 0) return -1;
+		}
+	}
+	g->out[start] = (int)(g->out_size - start - 1);
+	return 0;
+}
+
+// Make column d basic in row s and eliminate it from every other row
+static void pivot(GaussMatrix *g, int s, int d) {
+	int old = g->basic[s];
+	g->basic_row[old] = -1;
+	clear_bit(g->basic_mask, old);
+	g->basic[s] = d;
+	g->basic_row[d] = s;
+	set_bit(g->basic_mask, d);
+	const uint64_t *src = row_at(g, s);
+	for (int t = 0; t < g->num_rows; ++t) {
+		if (t == s) continue;
+		uint64_t *row = row_at(g, t);
+		if (!test_bit(row, d)) continue;
+		g->row_xor(row, src, g->words);
+		g->rhs[t] ^= g->rhs[s];
+		push_work(g, t);
+	}
+	g->pivots++;
+}
+
+// Restore the invariants of row s: an assigned basic column is swapped for
+// an unassigned one, and the row watches an unassigned non-basic column.
+// A row left with one unassigned column implies it; a fully assigned row
+// with the wrong parity is a conflict. Returns 0, 1 on conflict, -1 on error.
+static int check_row(GaussMatrix *g, int s) {
+	const uint64_t *row = row_at(g, s);
+	int b = g->basic[s];
+	if (test_bit(g->assigned, b)) {
+		int d = find_free(g, row);
+		if (d < 0) {
+			if (row_parity(g, row) == g->rhs[s]) return 0;
+			return emit_row_clause(g, s, -1, 0) == 0 ? 1 : -1;
+		}
+		pivot(g, s, d);
+		b = d;
+	}
+	int w = g->watch[s];
+	if (w >= 0 && test_bit(row, w) && !test_bit(g->assigned, w) && !test_bit(g->basic_mask, w)) return 0;
+	w = find_free(g, row);
+	if (w >= 0) {
+		g->watch[s] = w;
+		return rowlist_push(&g->watchers[w], s) == 0 ? 0 : -1;
+	}
+	// The basic column is the last unassigned one
+	int value = g->rhs[s] ^ row_parity(g, row);
+	g->watch[s] = -1;
+	if (emit_row_clause(g, s, b, value) != 0) return -1;
+	set_bit(g->assigned, b);
+	if (value) set_bit(g->value, b);
+	return 0;
+}
+
+static int run_work(GaussMatrix *g) {
+	while (g->work_size > 0) {
+		int s = g->work[--g->work_size];
+		g->in_work[s] = 0;
+		int r = check_row(g, s);
+		if (r != 0) {
+			while (g->work_size > 0) g->in_work[g->work[--g->work_size]] = 0;
+			return r;
+		}
+	}
+	return 0;
+}
+
+static void assign_col(GaussMatrix *g, int lit) {
+	int c = g->col_of_var[lit_var(lit)];
+	if (c < 0) return;
+	set_bit(g->assigned, c);
+	if (lit_neg(lit)) clear_bit(g->value, c);
+	else set_bit(g->value, c);
+}
+
+int gauss_propagate(GaussMatrix *g, const int8_t *vals, const int *trail, int trail_size) {
+	g->out_size = 0;
+	if (g->num_rows == 0) return GAUSS_NONE;
+	if (g->refresh || g->processed > trail_size) {
+		memset(g->assigned, 0, (size_t)g->words * sizeof(uint64_t));
+		memset(g->value, 0, (size_t)g->words * sizeof(uint64_t));
+		for (int c = 0; c < g->num_cols; ++c) {
+			int8_t v = vals[mk_lit(g->var_of_col[c], 0)];
+			if (v == LIT_UNDEF) continue;
+			set_bit(g->assigned, c);
+			if (v == LIT_TRUE) set_bit(g->value, c);
+		}
+		for (int c = 0; c < g->num_cols; ++c) g->watchers[c].size = 0;
+		for (int r = 0; r < g->num_rows; ++r) {
+			g->watch[r] = -1;
+			push_work(g, r);
+		}
+		g->refresh = 0;
+	} else {
+		for (int i = g->processed; i < trail_size; ++i) assign_col(g, trail[i]);
+		for (int i = g->processed; i < trail_size; ++i) {
+			int c = g->col_of_var[lit_var(trail[i])];
+			if (c < 0) continue;
+			if (g->basic_row[c] >= 0) push_work(g, g->basic_row[c]);
+			GaussRowList *l = &g->watchers[c];
+			for (int k = 0; k < l->size; ++k) {
+				if (g->watch[l->data[k]] == c) push_work(g, l->data[k]);
+			}
+			l->size = 0;
+		}
+	}
+	g->processed = trail_size;
+	int r = run_work(g);
+	if (r < 0) return GAUSS_ERROR;
+	if (r > 0) return GAUSS_CONFLICT;
+	return g->out_size ? GAUSS_PROPAGATE : GAUSS_NONE;
+}
+
+int gauss_init(GaussMatrix *g, int num_vars, const XorList *xors) {
+	memset(g, 0, sizeof(*g));
+	g->row_xor = select_row_xor();
+	g->col_of_var = (int *)malloc(((size_t)num_vars + 1) * sizeof(int));
+	if (!g->col_of_var) return -1;
+	for (int v = 0; v <= num_vars; ++v) g->col_of_var[v] = -1;
+	int cols = 0;
+	for (size_t at = 0; at < xors->size; at += 2 + (size_t)xors->data[at]) {
+		for (int t = 0; t < xors->data[at]; ++t) {
+			int v = xors->data[at + 2 + t];
+			if (g->col_of_var[v] < 0) g->col_of_var[v] = cols++;
+		}
+	}
+	int words = (cols + 63) / 64;
+	if (xors->num == 0 || (double)xors->num * (double)words > (double)GAUSS_MAX_WORDS) {
+		free(g->col_of_var);
+		g->col_of_var = NULL;
+		return 1;
+	}
+	int nr = (int)xors->num;
+	g->num_cols = cols;
+	g->words = words;
+	g->rows = (uint64_t *)calloc((size_t)nr * (size_t)words, sizeof(uint64_t));
+	g->rhs = (unsigned char *)calloc((size_t)nr, 1);
+	g->var_of_col = (int *)malloc((size_t)cols * sizeof(int));
+	g->basic = (int *)malloc((size_t)nr * sizeof(int));
+	g->basic_row = (int *)malloc((size_t)cols * sizeof(int));
+	g->watch = (int *)malloc((size_t)nr * sizeof(int));
+	g->watchers = (GaussRowList *)calloc((size_t)cols, sizeof(GaussRowList));
+	g->basic_mask = (uint64_t *)calloc((size_t)words, sizeof(uint64_t));
+	g->assigned = (uint64_t *)calloc((size_t)words, sizeof(uint64_t));
+	g->value = (uint64_t *)calloc((size_t)words, sizeof(uint64_t));
+	g->work = (int *)malloc((size_t)nr * sizeof(int));
+	g->in_work = (unsigned char *)calloc((size_t)nr, 1);
+	if (!g->rows || !g->rhs || !g->var_of_col || !g->basic || !g->basic_row || !g->watch || !g->watchers ||
+		!g->basic_mask || !g->assigned || !g->value || !g->work || !g->in_work) {
+		gauss_free(g);
+		return -1;
+	}
+	for (int v = 1; v <= num_vars; ++v) {
+		if (g->col_of_var[v] >= 0) g->var_of_col[g->col_of_var[v]] = v;
+	}
+	for (int c = 0; c < cols; ++c) g->basic_row[c] = -1;
+	size_t at = 0;
+	for (int r = 0; r < nr; ++r) {
+		int k = xors->data[at];
+		g->rhs[r] = (unsigned char)xors->data[at + 1];
+		uint64_t *row = row_at(g, r);
+		for (int t = 0; t < k; ++t) {
+			int c = g->col_of_var[xors->data[at + 2 + t]];
+			row[c >> 6] ^= 1ULL << (c & 63);
+		}
+		at += 2 + (size_t)k;
+	}
+
+	// Gauss-Jordan: the first column of each row becomes its basic column and
+	// is eliminated from all other rows; empty rows are dropped
+	int kept = 0;
+	for (int r = 0; r < nr; ++r) {
+		uint64_t *row = row_at(g, r);
+		int c = -1;
+		for (int i = 0; i < words && c < 0; ++i) {
+			if (row[i]) c = i * 64 + __builtin_ctzll(row[i]);
+		}
+		if (c < 0) {
+			if (g->rhs[r]) { gauss_free(g); return 0; }
+			continue;
+		}
+		for (int t = 0; t < nr; ++t) {
+			if (t == r) continue;
+			uint64_t *other = row_at(g, t);
+			if (!test_bit(other, c)) continue;
+			g->row_xor(other, row, words);
+			g->rhs[t] ^= g->rhs[r];
+		}
+		if (kept != r) {
+			memcpy(row_at(g, kept), row, (size_t)words * sizeof(uint64_t));
+			g->rhs[kept] = g->rhs[r];
+			memset(row, 0, (size_t)words * sizeof(uint64_t));
+		}
+		g->basic[kept] = c;
+		g->basic_row[c] = kept;
+		set_bit(g->basic_mask, c);
+		kept++;
+	}
+	g->num_rows = kept;
+	g->refresh = 1;
+	return 1;
+}
+
+int gauss_grow_vars(GaussMatrix *g, int old_vars, int new_vars) {
+	if (!g->col_of_var || new_vars <= old_vars) return 0;
+	int *cov = (int *)realloc(g->col_of_var, ((size_t)new_vars + 1) * sizeof(int));
+	if (!cov) return -1;
+	for (int v = old_vars + 1; v <= new_vars; ++v) cov[v] = -1;
+	g->col_of_var = cov;
+	return 0;
+}
+
+void gauss_free(GaussMatrix *g) {
+	if (!g) return;
+	if (g->watchers) {
+		for (int c = 0; c < g->num_cols; ++c) free(g->watchers[c].data);
+	}
+	free(g->rows);
+	free(g->rhs);
+	free(g->var_of_col);
+	free(g->col_of_var);
+	free(g->basic);
+	free(g->basic_row);
+	free(g->watch);
+	free(g->watchers);
+	free(g->basic_mask);
+	free(g->assigned);
+	free(g->value);
+	free(g->work);
+	free(g->in_work);
+	free(g->out);
+	memset(g, 0, sizeof(*g));
+}
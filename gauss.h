@@ -0,0 +1,92 @@
+// gauss.h - XOR constraints recovered from CNF and their GF(2) propagation
+#ifndef SAT_GAUSS_H
+#define SAT_GAUSS_H
+
+#include "clause_arena.h"
+#include <stddef.h>
+#include <stdint.h>
+
+// Longest XOR looked for; a k-variable XOR takes 2^(k-1) clauses
+#define XOR_MAX_SIZE 5
+
+// Records of (k, rhs, var_1 .. var_k): the variables sum to rhs modulo 2
+typedef struct XorList {
+	int *data;
+	size_t size;
+	size_t capacity;
+	size_t num;
+} XorList;
+
+// Find XORs encoded as every clause of one sign parity over the same
+// variables. refs are clauses of packed literals in 'arena'.
+// Returns the number found, -1 on allocation failure.
+int xor_detect(const ClauseArena *arena, const ClauseRef *refs, size_t count, XorList *out);
+void xor_list_free(XorList *x);
+
+typedef struct GaussRowList {
+	int *data;
+	int size;
+	int capacity;
+} GaussRowList;
+
+typedef void (*GaussRowXorFn)(uint64_t *dst, const uint64_t *src, int words);
+
+// XOR rows as packed 64-bit bitsets over the columns (variables in some
+// XOR). Every row has a basic column that appears in no other row and
+// watches one unassigned non-basic column; a row is only revisited when
+// one of those two is assigned, and pivots when its basic column is.
+typedef struct GaussMatrix {
+	int num_rows;
+	int num_cols;
+	int words;              // 64-bit words per row
+	uint64_t *rows;         // num_rows * words
+	unsigned char *rhs;
+	int *var_of_col;
+	int *col_of_var;        // -1 for variables in no XOR
+	int *basic;             // per row
+	int *basic_row;         // per column, -1 if non-basic
+	int *watch;             // per row, -1 if the row is fully assigned
+	GaussRowList *watchers; // per column: rows that may watch it
+	uint64_t *basic_mask;   // column bitsets
+	uint64_t *assigned;
+	uint64_t *value;
+	int *work;              // rows waiting to be checked
+	int work_size;
+	unsigned char *in_work;
+	int processed;          // trail prefix reflected in assigned/value
+	int refresh;            // rebuild assigned/value and watches from scratch
+	int *out;               // clause records (n, lits...) produced by gauss_propagate
+	size_t out_size;
+	size_t out_cap;
+	GaussRowXorFn row_xor;
+	unsigned long pivots;
+} GaussMatrix;
+
+enum {
+	GAUSS_ERROR = -1,
+	GAUSS_NONE = 0,         // nothing new
+	GAUSS_PROPAGATE = 1,    // out holds reasons: implied literal first, the rest false
+	GAUSS_CONFLICT = 2      // as GAUSS_PROPAGATE, then a last clause with every literal false
+};
+
+// Build the matrix and bring it to reduced row echelon form. Matrices over
+// the size limit are left empty. Returns 1 if ready, 0 if the XORs alone are
+// inconsistent, -1 on allocation failure.
+int gauss_init(GaussMatrix *g, int num_vars, const XorList *xors);
+void gauss_free(GaussMatrix *g);
+
+// The solver now has variables up to new_vars (none of them in an XOR).
+// Returns 0, -1 on allocation failure.
+int gauss_grow_vars(GaussMatrix *g, int old_vars, int new_vars);
+
+// Catch up with trail[0..trail_size) and report implied literals or a
+// conflict. 'vals' is the solver's per-literal value array.
+int gauss_propagate(GaussMatrix *g, const int8_t *vals, const int *trail, int trail_size);
+
+// The solver undid assignments; the next call rebuilds the watches
+static inline void gauss_backtrack(GaussMatrix *g) { g->refresh = 1; }
+
+// Row operation kernel chosen at gauss_init: "avx2" or "scalar"
+const char *gauss_kernel_name(const GaussMatrix *g);
+
+#endif // SAT_GAUSS_H
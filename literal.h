@@ -0,0 +1,25 @@
+// literal.h - Packed literal encoding used inside the solver
+#ifndef SAT_LITERAL_H
+#define SAT_LITERAL_H
+
+// A literal is 2*var for the positive and 2*var+1 for the negative polarity,
+// so negation is a bit flip and per-literal tables are indexed directly.
+// DIMACS signed integers are only used at the parser and output boundaries.
+
+static inline int mk_lit(int var, int negative) { return 2 * var + (negative ? 1 : 0); }
+static inline int lit_var(int lit) { return lit >> 1; }
+static inline int lit_neg(int lit) { return lit & 1; }
+static inline int lit_not(int lit) { return lit ^ 1; }
+
+static inline int lit_from_dimacs(int d) { return d > 0 ? 2 * d : 2 * -d + 1; }
+static inline int lit_to_dimacs(int lit) { return (lit & 1) ? -(lit >> 1) : (lit >> 1); }
+
+// Values of literals: a value array indexed by literal holds LIT_TRUE,
+// LIT_FALSE or LIT_UNDEF for both polarities of every variable
+enum {
+	LIT_FALSE = -1,
+	LIT_UNDEF = 0,
+	LIT_TRUE = 1
+};
+
+#endif // SAT_LITERAL_H
@@ -5,6 +5,8 @@
 #include "parser.h"
 #include "solver.h"
 #include "parser_opt.h"
+#include "out_buffer.h"
+#include "check.h"
 #include "sudoku.h"
 
 #ifdef _WIN32
@@ -36,7 +38,7 @@ void run_sat_mode() {
         return;
     }
     
-    printf("Enter options (--print, --model, --check, --timeout MS) or press Enter for none: ");
+    printf("Enter options (--print, --model, --check, --dpll, --timeout MS) or press Enter for none: ");
     char options[1024];
     if (fgets(options, sizeof(options), stdin) == NULL) {
         printf("Error reading input.\n");
@@ -50,6 +52,7 @@ void run_sat_mode() {
     int do_print = 0;
     int do_model = 0;
     int do_check = 0;
+    int use_dpll = 0;
     long timeout_ms = 0;
     
     char *token = strtok(options, " ");
@@ -57,6 +60,7 @@ void run_sat_mode() {
         if (strcmp(token, "--print") == 0) do_print = 1;
         else if (strcmp(token, "--model") == 0) do_model = 1;
         else if (strcmp(token, "--check") == 0) do_check = 1;
+        else if (strcmp(token, "--dpll") == 0) use_dpll = 1;
         else if (strcmp(token, "--timeout") == 0) {
             token = strtok(NULL, " ");
             if (token != NULL) timeout_ms = atol(token);
@@ -78,23 +82,31 @@ void run_sat_mode() {
         print_cnf(&cnf, stdout);
     }
     
-    // Optimized parser timing
+    // Pooled fgetc parser, timed for comparison only
     OptCNF ocnf;
     clock_t q0 = clock();
-    int opt_ok = parse_cnf_file_opt(path, &ocnf);
-    CNF cnf_opt;
-    int conv_ok = 0;
-    if (opt_ok == 0) {
-        conv_ok = (opt_cnf_to_cnf(&ocnf, &cnf_opt) == 0);
-        free_opt_cnf(&ocnf);
-    }
+    int pool_ok = (parse_cnf_file_opt(path, &ocnf) == 0);
     clock_t q1 = clock();
     double t_parse_opt_ms = (double)(q1 - q0) * 1000.0 / (double)CLOCKS_PER_SEC;
+    if (pool_ok) free_opt_cnf(&ocnf);
+    
+    // Memory-mapped parser: the solver works on its clause arena directly
+    clock_t r0 = clock();
+    int opt_ok = (parse_cnf_file_mmap(path, &ocnf) == 0);
+    clock_t r1 = clock();
+    double t_parse_mmap_ms = (double)(r1 - r0) * 1000.0 / (double)CLOCKS_PER_SEC;
     
     // Solve
     Assignment model;
     double ms = 0.0;
-    int res = dpll_solve(&cnf, &model, timeout_ms, &ms);
+    int res;
+    if (opt_ok) {
+        res = use_dpll ? dpll_solve_opt(&ocnf, &model, timeout_ms, &ms)
+                       : cdcl_solve_opt(&ocnf, &model, NULL, NULL, timeout_ms, &ms);
+    } else {
+        res = use_dpll ? dpll_solve(&cnf, &model, timeout_ms, &ms)
+                       : cdcl_solve(&cnf, &model, timeout_ms, &ms);
+    }
     
     // Prepare .res file path
     char outpath[4096];
@@ -105,45 +117,26 @@ void run_sat_mode() {
     memcpy(outpath, path, base_len);
     memcpy(outpath + base_len, ".res", 5);
     
-    FILE *rf = fopen(outpath, "w");
-    if (!rf) {
-        printf("Failed to open result file: %s\n", outpath);
+    int s_val = (res == 1 || res == 0) ? res : -1;
+    if (out_write_result(outpath, s_val, res == 1 ? model.values : NULL, res == 1 ? model.num_variables : 0, ms, 0) != 0) {
+        printf("Failed to write result file: %s\n", outpath);
         free_cnf(&cnf);
+        if (opt_ok) free_opt_cnf(&ocnf);
         if (res == 1) free_assignment(&model);
         return;
     }
     
-    int s_val = 0;
-    if (res == 1) s_val = 1;
-    else if (res == 0) s_val = 0;
-    else if (res == -1) s_val = -1;
-    else s_val = -1;
-    fprintf(rf, "s %d\n", s_val);
-    if (res == 1) {
-        fprintf(rf, "v ");
-        for (int v = 1; v <= model.num_variables; ++v) {
-            int lit = model.values[v] >= 0 ? v : -v;
-            if (model.values[v] == 0) lit = v;
-            fprintf(rf, "%d ", lit);
-        }
-        fprintf(rf, "\n");
-    }
-    fprintf(rf, "t %.0f\n", ms);
-    fclose(rf);
-    
     // Console output
     if (res == 1) {
         printf("SAT (%.0f ms) -> %s\n", ms, outpath);
         if (do_model) {
-            for (int v = 1; v <= model.num_variables; ++v) {
-                int lit = model.values[v] >= 0 ? v : -v;
-                if (model.values[v] == 0) lit = v;
-                printf("%d ", lit);
-            }
-            printf("0\n");
+            OutBuffer ob;
+            out_init(&ob, stdout);
+            out_model(&ob, model.values, model.num_variables, "", 0, 1);
+            out_flush(&ob);
         }
         if (do_check) {
-            int ok = verify_model_satisfies(&cnf, &model);
+            int ok = opt_ok ? check_model(&ocnf, &model, 0, NULL) : verify_model_satisfies(&cnf, &model);
             printf("check: %s\n", ok == 1 ? "OK" : (ok == 0 ? "FAIL" : "ERROR"));
         }
         free_assignment(&model);
@@ -156,18 +149,15 @@ void run_sat_mode() {
     }
     
     // Print parser timing comparison
-    if (conv_ok) {
-        printf("parse_ms=%.0f parse_opt_ms=%.0f", t_parse_ms, t_parse_opt_ms);
-        if (t_parse_ms > 0.0) {
-            double rate = (t_parse_ms - t_parse_opt_ms) / t_parse_ms * 100.0;
-            printf(" optimize=%.2f%%\n", rate);
-        } else {
-            printf("\n");
-        }
-        free_cnf(&cnf_opt);
-    } else {
-        printf("parse_ms=%.0f\n", t_parse_ms);
+    printf("parse_ms=%.0f", t_parse_ms);
+    if (pool_ok) printf(" parse_opt_ms=%.0f", t_parse_opt_ms);
+    if (opt_ok) printf(" parse_mmap_ms=%.0f scan=%s", t_parse_mmap_ms, parse_kernel_name(parse_kernel_detect()));
+    if (t_parse_ms > 0.0) {
+        if (pool_ok) printf(" optimize=%.2f%%", (t_parse_ms - t_parse_opt_ms) / t_parse_ms * 100.0);
+        if (opt_ok) printf(" mmap_optimize=%.2f%%", (t_parse_ms - t_parse_mmap_ms) / t_parse_ms * 100.0);
     }
+    printf("\n");
+    if (opt_ok) free_opt_cnf(&ocnf);
     free_cnf(&cnf);
 }
 
@@ -0,0 +1,147 @@
+#include "out_buffer.h"
+#include <stdarg.h>
+#include <string.h>
+
+static const char digit_pairs[201] =
+	"00010203040506070809"
+	"10111213141516171819"
+	"20212223242526272829"
+	"30313233343536373839"
+	"40414243444546474849"
+	"50515253545556575859"
+	"60616263646566676869"
+	"70717273747576777879"
+	"80818283848586878889"
+	"90919293949596979899";
+
+void out_init(OutBuffer *ob, FILE *fp) {
+	ob->fp = fp;
+	ob->len = 0;
+	ob->error = 0;
+}
+
+int out_flush(OutBuffer *ob) {
+	if (ob->len && fwrite(ob->buf, 1, ob->len, ob->fp) != ob->len) ob->error = 1;
+	ob->len = 0;
+	return ob->error ? -1 : 0;
+}
+
+void out_write(OutBuffer *ob, const char *s, size_t n) {
+	if (OUT_BUFFER_SIZE - ob->len < n) {
+		out_flush(ob);
+		if (n > OUT_BUFFER_SIZE) {
+			if (fwrite(s, 1, n, ob->fp) != n) ob->error = 1;
+			return;
+		}
+	}
+	memcpy(ob->buf + ob->len, s, n);
+	ob->len += n;
+}
+
+void out_puts(OutBuffer *ob, const char *s) {
+	out_write(ob, s, strlen(s));
+}
+
+void out_char(OutBuffer *ob, char c) {
+	if (ob->len == OUT_BUFFER_SIZE) out_flush(ob);
+	ob->buf[ob->len++] = c;
+}
+
+// Format v backwards ending at 'end', two digits per step. Returns the start.
+static char *format_uint(char *end, unsigned v) {
+	while (v >= 100) {
+		unsigned q = v / 100;
+		end -= 2;
+		memcpy(end, digit_pairs + 2 * (v - q * 100), 2);
+		v = q;
+	}
+	if (v >= 10) {
+		end -= 2;
+		memcpy(end, digit_pairs + 2 * v, 2);
+	} else {
+		*--end = (char)('0' + v);
+	}
+	return end;
+}
+
+void out_int(OutBuffer *ob, int v) {
+	if (OUT_BUFFER_SIZE - ob->len < 12) out_flush(ob);
+	char tmp[12];
+	char *end = tmp + sizeof(tmp);
+	char *p = format_uint(end, v < 0 ? 0u - (unsigned)v : (unsigned)v);
+	if (v < 0) *--p = '-';
+	memcpy(ob->buf + ob->len, p, (size_t)(end - p));
+	ob->len += (size_t)(end - p);
+}
+
+void out_printf(OutBuffer *ob, const char *fmt, ...) {
+	char line[512];
+	va_list ap;
+	va_start(ap, fmt);
+	int n = vsnprintf(line, sizeof(line), fmt, ap);
+	va_end(ap);
+	if (n < 0) { ob->error = 1; return; }
+	if ((size_t)n < sizeof(line)) {
+		out_write(ob, line, (size_t)n);
+		return;
+	}
+	// Longer than the scratch line: format straight into the stream
+	out_flush(ob);
+	va_start(ap, fmt);
+	if (vfprintf(ob->fp, fmt, ap) < 0) ob->error = 1;
+	va_end(ap);
+}
+
+void out_clause(OutBuffer *ob, const int *lits, size_t n) {
+	for (size_t i = 0; i < n; ++i) {
+		out_int(ob, lits[i]);
+		out_char(ob, ' ');
+	}
+	out_write(ob, "0\n", 2);
+}
+
+void out_model(OutBuffer *ob, const int *values, int num_variables, const char *prefix, int wrap, int terminate) {
+	size_t prefix_len = strlen(prefix);
+	out_write(ob, prefix, prefix_len);
+	size_t col = prefix_len;
+	char tmp[12];
+	char *end = tmp + sizeof(tmp);
+	for (int v = 1; v <= num_variables + (terminate ? 1 : 0); ++v) {
+		char *p;
+		if (v > num_variables) {
+			p = end - 1;
+			*p = '0';
+		} else {
+			p = format_uint(end, (unsigned)v);
+			if (values[v] < 0) *--p = '-';
+		}
+		size_t n = (size_t)(end - p);
+		if (wrap > 0 && col > prefix_len && col + n + 1 > (size_t)wrap) {
+			out_char(ob, '\n');
+			out_write(ob, prefix, prefix_len);
+			col = prefix_len;
+		}
+		if (OUT_BUFFER_SIZE - ob->len < n + 1) out_flush(ob);
+		memcpy(ob->buf + ob->len, p, n);
+		ob->len += n;
+		if (v <= num_variables) ob->buf[ob->len++] = ' ';
+		col += n + 1;
+	}
+	out_char(ob, '\n');
+}
+
+int out_write_result(const char *path, int status, const int *values, int num_variables, double ms, int wrap) {
+	FILE *fp = fopen(path, "w");
+	if (!fp) return -1;
+	OutBuffer ob;
+	out_init(&ob, fp);
+	out_printf(&ob, "s %d\n", status);
+	if (status == 1) {
+		if (wrap > 0) out_model(&ob, values, num_variables, "v ", wrap, 1);
+		else out_model(&ob, values, num_variables, "v ", 0, 0);
+	}
+	out_printf(&ob, "t %.0f\n", ms);
+	int r = out_flush(&ob);
+	if (fclose(fp) != 0) r = -1;
+	return r;
+}
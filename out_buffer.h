@@ -0,0 +1,49 @@
+// out_buffer.h - Buffered text output for results, models and CNF files
+#ifndef SAT_OUT_BUFFER_H
+#define SAT_OUT_BUFFER_H
+
+#include <stdio.h>
+#include <stddef.h>
+
+#define OUT_BUFFER_SIZE (1u << 16)
+
+// Text is formatted straight into an embedded buffer and handed to the
+// stream in OUT_BUFFER_SIZE blocks, so writing never allocates
+typedef struct OutBuffer {
+	FILE *fp;
+	size_t len;
+	int error;
+	char buf[OUT_BUFFER_SIZE];
+} OutBuffer;
+
+void out_init(OutBuffer *ob, FILE *fp);
+
+// Write the buffered text to the stream. Returns 0, or -1 after any write error.
+int out_flush(OutBuffer *ob);
+
+void out_write(OutBuffer *ob, const char *s, size_t n);
+void out_puts(OutBuffer *ob, const char *s);
+void out_char(OutBuffer *ob, char c);
+void out_int(OutBuffer *ob, int v);
+
+// printf for the occasional header or timing line
+void out_printf(OutBuffer *ob, const char *fmt, ...)
+#ifdef __GNUC__
+	__attribute__((format(printf, 2, 3)))
+#endif
+	;
+
+// One DIMACS clause line: "l1 l2 ... 0\n"
+void out_clause(OutBuffer *ob, const int *lits, size_t n);
+
+// Model literals for variables 1..num_variables (values -1/0/1, unassigned
+// written as positive). Every line starts with 'prefix'; wrap > 0 breaks
+// lines before they exceed that many columns; terminate appends the final 0.
+void out_model(OutBuffer *ob, const int *values, int num_variables, const char *prefix, int wrap, int terminate);
+
+// Result file: "s <status>", the model as "v" lines when status is 1, and
+// "t <ms>". wrap > 0 writes competition-style "v ... 0" lines of at most
+// wrap columns instead of one unterminated line. Returns 0 on success.
+int out_write_result(const char *path, int status, const int *values, int num_variables, double ms, int wrap);
+
+#endif // SAT_OUT_BUFFER_H
@@ -0,0 +1,39 @@
+#include "parallel.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include <time.h>
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+double wall_ms(void) {
+	struct timespec ts;
+	timespec_get(&ts, TIME_UTC);
+	return (double)ts.tv_sec * 1000.0 + (double)ts.tv_nsec / 1e6;
+}
+
+int cpu_count(void) {
+#if !defined(_WIN32) && defined(_SC_NPROCESSORS_ONLN)
+	long n = sysconf(_SC_NPROCESSORS_ONLN);
+	if (n > 0) return (int)n;
+#endif
+	return 1;
+}
+
+int parallel_run(void *items, size_t item_size, int count, void *(*fn)(void *), int run_unstarted) {
+	if (count <= 0) return 0;
+	char *base = (char *)items;
+	pthread_t *tids = count > 1 ? (pthread_t *)malloc((size_t)count * sizeof(pthread_t)) : NULL;
+	int started = 1;
+	for (; tids && started < count; ++started) {
+		if (pthread_create(&tids[started], NULL, fn, base + (size_t)started * item_size) != 0) break;
+	}
+	fn(base);
+	int ran = started;
+	if (run_unstarted) {
+		for (; ran < count; ++ran) fn(base + (size_t)ran * item_size);
+	}
+	for (int k = 1; k < started; ++k) pthread_join(tids[k], NULL);
+	free(tids);
+	return ran;
+}
@@ -0,0 +1,20 @@
+// parallel.h - Timing and thread start-up shared by the multi-threaded modules
+#ifndef SAT_PARALLEL_H
+#define SAT_PARALLEL_H
+
+#include <stddef.h>
+
+// Wall-clock milliseconds; clock() would add up the CPU time of all threads
+double wall_ms(void);
+
+// Online CPUs, 1 if unknown
+int cpu_count(void);
+
+// Call fn on each of 'count' items of 'item_size' bytes starting at 'items',
+// one thread per item; the calling thread takes item 0. With 'run_unstarted'
+// the items whose thread could not be created run on the calling thread
+// afterwards, otherwise they are skipped. Returns once every call has
+// finished: the number of items fn ran on, always a prefix of the array.
+int parallel_run(void *items, size_t item_size, int count, void *(*fn)(void *), int run_unstarted);
+
+#endif // SAT_PARALLEL_H
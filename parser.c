@@ -1,4 +1,5 @@
 #include "parser.h"
+#include "out_buffer.h"
 #include <string.h>
 #include <ctype.h>
 
@@ -133,15 +134,14 @@ void free_cnf(CNF *cnf) {
 
 void print_cnf(const CNF *cnf, FILE *stream) {
 	if (!cnf) return;
-	FILE *out = stream ? stream : stdout;
-	fprintf(out, "p cnf %d %zu\n", cnf->num_variables, cnf->num_clauses);
+	OutBuffer ob;
+	out_init(&ob, stream ? stream : stdout);
+	out_printf(&ob, "p cnf %d %zu\n", cnf->num_variables, cnf->num_clauses);
 	for (size_t i = 0; i < cnf->num_clauses; ++i) {
 		const Clause *cl = &cnf->clauses[i];
-		for (size_t j = 0; j < cl->num_literals; ++j) {
-			fprintf(out, "%d ", cl->literals[j]);
-		}
-		fprintf(out, "0\n");
+		out_clause(&ob, cl->literals, cl->num_literals);
 	}
+	out_flush(&ob);
 }
 
 
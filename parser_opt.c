@@ -1,8 +1,13 @@
 #include "parser_opt.h"
+#include "cnf_input.h"
+#include "cnf_stream.h"
+#include "cnf_cache.h"
+#include "parser_simd.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
+#include <limits.h>
 
 static int parse_header_line(FILE *fp, int *num_vars, size_t *num_clauses) {
 	char line[4096];
@@ -33,8 +38,35 @@ static int parse_header_line(FILE *fp, int *num_vars, size_t *num_clauses) {
 	return -1;
 }
 
+int opt_cnf_init(OptCNF *cnf, int num_variables) {
+	if (!cnf || num_variables < 0) return -1;
+	memset(cnf, 0, sizeof(*cnf));
+	cnf->num_variables = num_variables;
+	return arena_init(&cnf->arena, 1024);
+}
+
+static int push_clause_ref(OptCNF *cnf, ClauseRef ref) {
+	if (cnf->num_clauses == cnf->clauses_cap) {
+		size_t new_cap = cnf->clauses_cap ? cnf->clauses_cap * 2 : 256;
+		ClauseRef *arr = (ClauseRef *)realloc(cnf->clauses, new_cap * sizeof(ClauseRef));
+		if (!arr) return -1;
+		cnf->clauses = arr;
+		cnf->clauses_cap = new_cap;
+	}
+	cnf->clauses[cnf->num_clauses++] = ref;
+	return 0;
+}
+
+int opt_cnf_add_clause(OptCNF *cnf, const int *lits, size_t n) {
+	if (!cnf || (n && !lits) || n >= UINT32_MAX || cnf->map) return -1;
+	ClauseRef ref = arena_alloc(&cnf->arena, lits, (uint32_t)n);
+	if (ref == CLAUSE_REF_UNDEF) return -1;
+	return push_clause_ref(cnf, ref);
+}
+
 int parse_cnf_file_opt(const char *path, OptCNF *out) {
 	if (!path || !out) return -1;
+	if (cnf_stream_needed(path)) return parse_cnf_file_stream(path, out);
 	memset(out, 0, sizeof(*out));
 	FILE *fp = fopen(path, "r");
 	if (!fp) return -1;
@@ -42,20 +74,17 @@ int parse_cnf_file_opt(const char *path, OptCNF *out) {
 	size_t num_clauses = 0;
 	if (parse_header_line(fp, &num_vars, &num_clauses) != 0) { fclose(fp); return -1; }
 	out->num_variables = num_vars;
-	out->num_clauses = num_clauses;
-	out->clauses = (OptClause *)calloc(num_clauses, sizeof(OptClause));
+	out->clauses_cap = num_clauses ? num_clauses : 1;
+	out->clauses = (ClauseRef *)malloc(out->clauses_cap * sizeof(ClauseRef));
 	if (!out->clauses) { fclose(fp); return -1; }
 
-	// We'll push literals into a growing pool
-	size_t pool_cap = 1024;
-	out->literals_pool = (int *)malloc(pool_cap * sizeof(int));
-	if (!out->literals_pool) { free(out->clauses); fclose(fp); return -1; }
-	out->pool_len = 0;
+	// Clauses are written straight into the arena: header first, literals after
+	if (arena_init(&out->arena, num_clauses * 8 + 1024) != 0) { free_opt_cnf(out); fclose(fp); return -1; }
+	ClauseArena *arena = &out->arena;
 
 	char token[64];
 	int c;
-	size_t clause_idx = 0;
-	while (clause_idx < num_clauses) {
+	while (out->num_clauses < num_clauses) {
 		// skip whitespace and comments
 		c = fgetc(fp);
 		if (c == EOF) break;
@@ -73,25 +102,25 @@ int parse_cnf_file_opt(const char *path, OptCNF *out) {
 			token[len++] = (char)c;
 		}
 		token[len] = '\0';
+		if (token[0] == '%') break; // SATLIB end marker
 		int lit = atoi(token);
 		if (lit == 0) {
+			// A 0 with no literals before it is the empty clause
+			ClauseRef ref = arena_alloc(arena, NULL, 0);
+			if (ref == CLAUSE_REF_UNDEF) { free_opt_cnf(out); fclose(fp); return -1; }
+			out->clauses[out->num_clauses++] = ref;
 			continue;
 		}
 		// Begin a new clause: we already have first literal
-		OptClause *cl = &out->clauses[clause_idx];
-		cl->start_index = out->pool_len;
-		cl->num_literals = 0;
+		if (arena_reserve(arena, ARENA_HEADER_WORDS) != 0) { free_opt_cnf(out); fclose(fp); return -1; }
+		ClauseRef ref = arena->size;
+		arena->size += ARENA_HEADER_WORDS;
+		uint32_t n = 0;
 		for (;;) {
 			// push lit
-			if (out->pool_len == pool_cap) {
-				size_t new_cap = pool_cap * 2;
-				int *new_pool = (int *)realloc(out->literals_pool, new_cap * sizeof(int));
-				if (!new_pool) { fclose(fp); return -1; }
-				out->literals_pool = new_pool;
-				pool_cap = new_cap;
-			}
-			out->literals_pool[out->pool_len++] = lit;
-			cl->num_literals++;
+			if (arena->size == arena->cap && arena_reserve(arena, 1) != 0) { free_opt_cnf(out); fclose(fp); return -1; }
+			arena->mem[arena->size++] = (uint32_t)lit;
+			n++;
 			// read next token until we hit 0
 			while ((c = fgetc(fp)) != EOF && isspace(c)) {}
 			if (c == EOF) break;
@@ -107,45 +136,194 @@ int parse_cnf_file_opt(const char *path, OptCNF *out) {
 			lit = atoi(token);
 			if (lit == 0) break;
 		}
-		clause_idx++;
+		ArenaClause *cl = arena_clause(arena, ref);
+		cl->size = n;
+		cl->flags = 0;
+		cl->lbd = 0;
+		cl->u.activity = 0.0f;
+		out->clauses[out->num_clauses++] = ref;
 	}
-	// Adjust actual number of clauses parsed
-	if (clause_idx != num_clauses) out->num_clauses = clause_idx;
 	fclose(fp);
 	return 0;
 }
 
-void free_opt_cnf(OptCNF *cnf) {
-	if (!cnf) return;
-	free(cnf->clauses);
-	free(cnf->literals_pool);
-	cnf->clauses = NULL;
-	cnf->literals_pool = NULL;
-	cnf->num_clauses = 0;
-	cnf->num_variables = 0;
-	cnf->pool_len = 0;
-}
-
-int opt_cnf_to_cnf(const OptCNF *src, CNF *dst) {
-	if (!src || !dst) return -1;
-	memset(dst, 0, sizeof(*dst));
-	dst->num_variables = src->num_variables;
-	dst->num_clauses = src->num_clauses;
-	dst->clauses = (Clause *)calloc(src->num_clauses, sizeof(Clause));
-	if (!dst->clauses) return -1;
-	for (size_t i = 0; i < src->num_clauses; ++i) {
-		const OptClause *ocl = &src->clauses[i];
-		Clause *cl = &dst->clauses[i];
-		cl->num_literals = ocl->num_literals;
-		if (ocl->num_literals == 0) {
-			cl->literals = NULL;
+static const char *skip_line_buf(const char *p, const char *end) {
+	const char *nl = (const char *)memchr(p, '\n', (size_t)(end - p));
+	return nl ? nl + 1 : end;
+}
+
+static const char *skip_blanks_buf(const char *p, const char *end) {
+	while (p < end && (*p == ' ' || *p == '\t')) p++;
+	return p;
+}
+
+// Scan an unsigned decimal at p. Returns the position after it, or NULL if
+// there is no digit or the value exceeds INT_MAX.
+static const char *scan_uint(const char *p, const char *end, unsigned *out) {
+	unsigned d;
+	if (p >= end || (d = (unsigned)((unsigned char)*p - '0')) > 9) return NULL;
+	unsigned v = 0;
+	do {
+		if (v > (unsigned)INT_MAX / 10) return NULL;
+		v = v * 10 + d;
+		if (v > (unsigned)INT_MAX) return NULL;
+		++p;
+	} while (p < end && (d = (unsigned)((unsigned char)*p - '0')) <= 9);
+	*out = v;
+	return p;
+}
+
+const char *scan_header(const char *p, const char *end, int *num_vars, size_t *num_clauses) {
+	while (p < end) {
+		unsigned char c = (unsigned char)*p;
+		if (c <= ' ') { p++; continue; }
+		if (c == 'c' || c == 'C') { p = skip_line_buf(p, end); continue; }
+		if (c != 'p' && c != 'P') return NULL;
+		p = skip_blanks_buf(p + 1, end);
+		if (end - p < 3 || (memcmp(p, "cnf", 3) != 0 && memcmp(p, "CNF", 3) != 0)) return NULL;
+		unsigned nv, nc;
+		p = scan_uint(skip_blanks_buf(p + 3, end), end, &nv);
+		if (!p) return NULL;
+		p = scan_uint(skip_blanks_buf(p, end), end, &nc);
+		if (!p) return NULL;
+		*num_vars = (int)nv;
+		*num_clauses = nc;
+		return skip_line_buf(p, end);
+	}
+	return NULL;
+}
+
+// Byte-at-a-time clause scanner; the portable fallback of simd_scan_clauses
+static int scalar_scan_clauses(const char *p, const char *end, OptCNF *out, size_t num_clauses, ClauseRef *open) {
+	while (p < end && out->num_clauses < num_clauses) {
+		unsigned char c = (unsigned char)*p;
+		if (c <= ' ') { p++; continue; }
+		if (c == 'c' || c == 'C') { p = skip_line_buf(p, end); continue; }
+		if (c == '%') return 1; // SATLIB end marker
+		// Signs as atoi reads them: "+2" is 2, "-0" ends the clause like "0"
+		int neg = (c == '-');
+		unsigned v;
+		p = scan_uint(p + (neg || c == '+'), end, &v);
+		if (!p || (p < end && (unsigned char)*p > ' ')) return -1;
+		if (v == 0) {
+			if (scan_close_clause(out, open) != 0) return -1;
 			continue;
 		}
-		cl->literals = (int *)malloc(ocl->num_literals * sizeof(int));
-		if (!cl->literals) return -1;
-		memcpy(cl->literals, src->literals_pool + ocl->start_index, ocl->num_literals * sizeof(int));
+		if (scan_push_lit(&out->arena, open, neg ? -(int)v : (int)v) != 0) return -1;
+	}
+	return 0;
+}
+
+int scan_clauses(ParseKernel kernel, const char *p, const char *end, OptCNF *out, size_t num_clauses,
+	ClauseRef *open) {
+	if (kernel > parse_kernel_detect()) kernel = parse_kernel_detect();
+	if (kernel == PARSE_KERNEL_SCALAR) return scalar_scan_clauses(p, end, out, num_clauses, open);
+	return simd_scan_clauses(kernel, p, end, out, num_clauses, open);
+}
+
+int parse_cnf_buffer_kernel(const char *data, size_t size, OptCNF *out, ParseKernel kernel) {
+	if (!data || !out) return -1;
+	memset(out, 0, sizeof(*out));
+	const char *p = data, *end = data + size;
+	int num_vars = 0;
+	size_t num_clauses = 0;
+	p = scan_header(p, end, &num_vars, &num_clauses);
+	if (!p) return -1;
+	out->num_variables = num_vars;
+	out->clauses_cap = num_clauses ? num_clauses : 1;
+	out->clauses = (ClauseRef *)malloc(out->clauses_cap * sizeof(ClauseRef));
+	// Every literal takes at least two bytes of input
+	if (!out->clauses || arena_init(&out->arena, (size_t)(end - p) / 2 + num_clauses * ARENA_HEADER_WORDS + 1024) != 0) {
+		free_opt_cnf(out);
+		return -1;
+	}
+	ClauseRef open = CLAUSE_REF_UNDEF;
+	if (scan_clauses(kernel, p, end, out, num_clauses, &open) < 0) { free_opt_cnf(out); return -1; }
+	// Last clause without its terminating 0
+	if (open != CLAUSE_REF_UNDEF && out->num_clauses < num_clauses && scan_close_clause(out, &open) != 0) {
+		free_opt_cnf(out);
+		return -1;
 	}
 	return 0;
 }
 
+int parse_cnf_buffer_opt(const char *data, size_t size, OptCNF *out) {
+	return parse_cnf_buffer_kernel(data, size, out, parse_kernel_detect());
+}
+
+int parse_cnf_file_mmap(const char *path, OptCNF *out) {
+	if (!path || !out) return -1;
+	if (cnf_stream_needed(path)) return parse_cnf_file_stream(path, out);
+	CnfInput in;
+	if (cnf_input_open(path, &in) != 0) return -1;
+	int r = parse_cnf_buffer_opt(in.data, in.size, out);
+	cnf_input_close(&in);
+	return r;
+}
+
+// Skip blank and comment lines
+static const char *skip_comments_buf(const char *p, const char *end) {
+	while (p < end) {
+		unsigned char c = (unsigned char)*p;
+		if (c <= ' ') p++;
+		else if (c == 'c' || c == 'C') p = skip_line_buf(p, end);
+		else break;
+	}
+	return p;
+}
 
+int parse_cnf_file_stream(const char *path, OptCNF *out) {
+	if (!path || !out) return -1;
+	memset(out, 0, sizeof(*out));
+	CnfStream *s = cnf_stream_open(path);
+	if (!s) return -1;
+	// Blocks end at line boundaries, so neither the header nor a literal is
+	// ever split; only clauses continue from one block into the next
+	const char *p = NULL, *end = NULL;
+	ptrdiff_t n;
+	while ((n = cnf_stream_next(s, &p)) > 0) {
+		end = p + n;
+		p = skip_comments_buf(p, end);
+		if (p < end) break;
+	}
+	int num_vars = 0;
+	size_t num_clauses = 0;
+	if (n <= 0 || !(p = scan_header(p, end, &num_vars, &num_clauses))) { cnf_stream_close(s); return -1; }
+	out->num_variables = num_vars;
+	out->clauses_cap = num_clauses ? num_clauses : 1;
+	out->clauses = (ClauseRef *)malloc(out->clauses_cap * sizeof(ClauseRef));
+	if (!out->clauses || arena_init(&out->arena, num_clauses * 8 + 1024) != 0) {
+		free_opt_cnf(out);
+		cnf_stream_close(s);
+		return -1;
+	}
+	// The next block is decoded on the stream's thread while this one is scanned
+	ParseKernel kernel = parse_kernel_detect();
+	ClauseRef open = CLAUSE_REF_UNDEF;
+	int r = scan_clauses(kernel, p, end, out, num_clauses, &open);
+	while (r == 0 && out->num_clauses < num_clauses && (n = cnf_stream_next(s, &p)) > 0) {
+		r = scan_clauses(kernel, p, p + n, out, num_clauses, &open);
+	}
+	cnf_stream_close(s);
+	if (r < 0 || n < 0) { free_opt_cnf(out); return -1; }
+	// Last clause without its terminating 0
+	if (open != CLAUSE_REF_UNDEF && out->num_clauses < num_clauses && scan_close_clause(out, &open) != 0) {
+		free_opt_cnf(out);
+		return -1;
+	}
+	return 0;
+}
+
+void free_opt_cnf(OptCNF *cnf) {
+	if (!cnf) return;
+	if (cnf->map) {
+		cnf_cache_unmap(cnf);
+		return;
+	}
+	free(cnf->clauses);
+	arena_free(&cnf->arena);
+	cnf->clauses = NULL;
+	cnf->clauses_cap = 0;
+	cnf->num_clauses = 0;
+	cnf->num_variables = 0;
+}
@@ -4,30 +4,64 @@
 
 #include <stddef.h>
 #include "parser.h"
-
-typedef struct OptClause {
-	size_t start_index;   // start index in literals_pool
-	size_t num_literals;  // number of literals in this clause
-} OptClause;
+#include "clause_arena.h"
 
 typedef struct OptCNF {
 	int num_variables;
 	size_t num_clauses;
-	OptClause *clauses;   // array length = num_clauses
-	int *literals_pool;   // contiguous pool of all clause literals
-	size_t pool_len;      // number of used entries in pool
+	ClauseRef *clauses;   // arena offset of each clause, in input order
+	size_t clauses_cap;
+	ClauseArena arena;    // clause headers and literals in one contiguous block
+	void *map;            // cnf_cache_load mapping that clauses and arena point into, else NULL
+	size_t map_len;
 } OptCNF;
 
 // Parse into optimized representation. Returns 0 on success.
 int parse_cnf_file_opt(const char *path, OptCNF *out);
 
-// Free optimized CNF memory.
-void free_opt_cnf(OptCNF *cnf);
+// Same result as parse_cnf_file_opt, but the whole file is memory-mapped (or
+// read in large blocks for pipes) and integers are scanned in place.
+int parse_cnf_file_mmap(const char *path, OptCNF *out);
 
-// Convert optimized CNF into standard CNF used by the solver.
-// Returns 0 on success. Caller must later free_cnf on 'dst'.
-int opt_cnf_to_cnf(const OptCNF *src, CNF *dst);
+// Parse stdin ("-") or a gzip/xz/bzip2 file, decompressing on a second
+// thread while earlier blocks are scanned. parse_cnf_file_opt,
+// parse_cnf_file_mmap and parse_cnf_file_parallel hand such inputs here.
+int parse_cnf_file_stream(const char *path, OptCNF *out);
 
-#endif // SAT_PARSER_OPT_H
+// Parse DIMACS text held in memory with the widest tokenizer the CPU
+// supports. Returns 0 on success.
+int parse_cnf_buffer_opt(const char *data, size_t size, OptCNF *out);
+
+// Clause tokenizers: the vector kernels classify 64 input bytes per step and
+// convert whole digit runs at once; scalar is the portable fallback
+typedef enum ParseKernel {
+	PARSE_KERNEL_SCALAR = 0,
+	PARSE_KERNEL_SSE42 = 1,
+	PARSE_KERNEL_AVX2 = 2
+} ParseKernel;
+
+// Widest kernel supported by the running CPU (detected once)
+ParseKernel parse_kernel_detect(void);
+const char *parse_kernel_name(ParseKernel kernel);
+
+// parse_cnf_buffer_opt with an explicit kernel; kernels the CPU lacks are
+// replaced by the widest supported one
+int parse_cnf_buffer_kernel(const char *data, size_t size, OptCNF *out, ParseKernel kernel);
 
+// Split the clause section at line starts and scan the pieces on up to
+// 'threads' threads (<= 0: one per online CPU), then stitch them into one
+// arena. The result is identical to parse_cnf_buffer_opt, clause order
+// included; small inputs are parsed sequentially. Returns 0 on success.
+int parse_cnf_buffer_parallel(const char *data, size_t size, OptCNF *out, int threads);
+int parse_cnf_file_parallel(const char *path, OptCNF *out, int threads);
 
+// Initialize an empty formula over num_variables variables. Returns 0 on success.
+int opt_cnf_init(OptCNF *cnf, int num_variables);
+
+// Append a clause. Returns 0 on success; fails on a mapped cache.
+int opt_cnf_add_clause(OptCNF *cnf, const int *lits, size_t n);
+
+// Free optimized CNF memory.
+void free_opt_cnf(OptCNF *cnf);
+
+#endif // SAT_PARSER_OPT_H
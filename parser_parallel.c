@@ -0,0 +1,221 @@
+#include "parser_simd.h"
+#include "cnf_input.h"
+#include "cnf_stream.h"
+#include "parallel.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Chunks smaller than this are not worth a thread
+#ifndef PARSE_MIN_CHUNK
+#define PARSE_MIN_CHUNK (1u << 20)
+#endif
+#define PARSE_MAX_THREADS 64
+
+// One slice of the clause section, parsed into its own pool. The pool always
+// starts with the "head": the literals before the first 0 of the chunk,
+// which either finish the previous chunk's open clause or form a clause of
+// their own. The "tail" is the clause still open at the end of the chunk.
+typedef struct ParseChunk {
+	const char *begin;
+	const char *end;
+	ParseKernel kernel;
+	OptCNF pool;        // clauses[0] is the head once a 0 was seen
+	int head_closed;
+	ClauseRef tail;     // CLAUSE_REF_UNDEF if the chunk ends on a 0
+	int status;         // scan_clauses result
+
+	// Stitching: pool words [copy_from, size) go to 'dest' in the final arena
+	uint32_t copy_from;
+	uint32_t dest;
+	ClauseArena *target;
+} ParseChunk;
+
+static void *parse_chunk_worker(void *arg) {
+	ParseChunk *ch = (ParseChunk *)arg;
+	OptCNF *pool = &ch->pool;
+	ch->tail = CLAUSE_REF_UNDEF;
+	if (arena_init(&pool->arena, (size_t)(ch->end - ch->begin) / 2 + 1024) != 0) {
+		ch->status = -1;
+		return NULL;
+	}
+	// Open the head up front so it sits at offset 0 even when it is empty
+	ClauseArena *arena = &pool->arena;
+	ArenaClause *head = arena_clause(arena, 0);
+	head->flags = 0;
+	head->lbd = 0;
+	head->u.activity = 0.0f;
+	arena->size = ARENA_HEADER_WORDS;
+	ClauseRef open = 0;
+	ch->status = scan_clauses(ch->kernel, ch->begin, ch->end, pool, SIZE_MAX, &open);
+	if (ch->status < 0) return NULL;
+	ch->head_closed = pool->num_clauses > 0;
+	if (open != CLAUSE_REF_UNDEF) {
+		arena_clause(arena, open)->size = arena->size - open - ARENA_HEADER_WORDS;
+		if (ch->head_closed) ch->tail = open;
+	}
+	return NULL;
+}
+
+static void *copy_chunk_worker(void *arg) {
+	ParseChunk *ch = (ParseChunk *)arg;
+	const ClauseArena *src = &ch->pool.arena;
+	memcpy(ch->target->mem + ch->dest, src->mem + ch->copy_from,
+		(size_t)(src->size - ch->copy_from) * sizeof(uint32_t));
+	return NULL;
+}
+
+static int push_ref(OptCNF *out, ClauseRef ref) {
+	if (out->num_clauses == out->clauses_cap) {
+		size_t new_cap = out->clauses_cap ? out->clauses_cap * 2 : 256;
+		ClauseRef *arr = (ClauseRef *)realloc(out->clauses, new_cap * sizeof(ClauseRef));
+		if (!arr) return -1;
+		out->clauses = arr;
+		out->clauses_cap = new_cap;
+	}
+	out->clauses[out->num_clauses++] = ref;
+	return 0;
+}
+
+typedef struct SizeFix {
+	ClauseRef ref;
+	uint32_t size;
+} SizeFix;
+
+// Lay the chunk pools out back to back (prefix sums of their sizes), gluing
+// each open tail to the next head by dropping the head's header, and build
+// the clause list in input order. Returns 0 on success, -1 on allocation
+// failure.
+static int plan_stitch(ParseChunk *chunks, int *count, OptCNF *out, SizeFix *fixes, int *num_fixes,
+	size_t *total_words) {
+	size_t total = 0;
+	ClauseRef open_ref = CLAUSE_REF_UNDEF;
+	uint32_t open_size = 0;
+	*num_fixes = 0;
+	int k = 0;
+	for (; k < *count; ++k) {
+		ParseChunk *ch = &chunks[k];
+		const OptCNF *pool = &ch->pool;
+		uint32_t head_size = arena_clause(&pool->arena, 0)->size;
+		int merged = open_ref != CLAUSE_REF_UNDEF;
+		// An unmerged head closed with no literals is an empty clause of its own
+		int head_clause = !merged && (head_size > 0 || ch->head_closed);
+		ch->copy_from = head_clause ? 0 : ARENA_HEADER_WORDS;
+		if (total + pool->arena.size >= (size_t)UINT32_MAX) return -1;
+		ch->dest = (uint32_t)total;
+		uint32_t shift = ch->dest - ch->copy_from; // pool offset -> final offset (mod 2^32)
+		if (merged) {
+			open_size += head_size;
+			if (ch->head_closed) {
+				if (push_ref(out, open_ref) != 0) return -1;
+				fixes[*num_fixes].ref = open_ref;
+				fixes[(*num_fixes)++].size = open_size;
+				open_ref = CLAUSE_REF_UNDEF;
+			}
+		} else if (head_clause) {
+			if (ch->head_closed) {
+				if (push_ref(out, ch->dest) != 0) return -1;
+			} else {
+				open_ref = ch->dest;
+				open_size = head_size;
+			}
+		}
+		for (size_t i = 1; i < pool->num_clauses; ++i) {
+			if (push_ref(out, pool->clauses[i] + shift) != 0) return -1;
+		}
+		if (ch->tail != CLAUSE_REF_UNDEF) {
+			open_ref = ch->tail + shift;
+			open_size = arena_clause(&pool->arena, ch->tail)->size;
+		}
+		total += pool->arena.size - ch->copy_from;
+		if (ch->status == 1) { k++; break; } // '%' end marker: ignore the rest
+	}
+	*count = k;
+	// Last clause without its terminating 0
+	if (open_ref != CLAUSE_REF_UNDEF) {
+		if (push_ref(out, open_ref) != 0) return -1;
+		fixes[*num_fixes].ref = open_ref;
+		fixes[(*num_fixes)++].size = open_size;
+	}
+	*total_words = total;
+	return 0;
+}
+
+static void free_chunks(ParseChunk *chunks, int count) {
+	for (int k = 0; k < count; ++k) free_opt_cnf(&chunks[k].pool);
+	free(chunks);
+}
+
+int parse_cnf_buffer_parallel(const char *data, size_t size, OptCNF *out, int threads) {
+	if (!data || !out) return -1;
+	const char *end = data + size;
+	int num_vars = 0;
+	size_t num_clauses = 0;
+	const char *body = scan_header(data, end, &num_vars, &num_clauses);
+	if (!body) { memset(out, 0, sizeof(*out)); return -1; }
+	size_t len = (size_t)(end - body);
+	if (threads <= 0) threads = cpu_count();
+	if ((size_t)threads > len / PARSE_MIN_CHUNK) threads = (int)(len / PARSE_MIN_CHUNK);
+	if (threads > PARSE_MAX_THREADS) threads = PARSE_MAX_THREADS;
+	if (threads <= 1) return parse_cnf_buffer_opt(data, size, out);
+
+	ParseChunk *chunks = (ParseChunk *)calloc((size_t)threads, sizeof(ParseChunk));
+	if (!chunks) return -1;
+	// Cut at line starts so comment lines and the SIMD window carry stay intact
+	const char *cut = body;
+	ParseKernel kernel = parse_kernel_detect();
+	for (int k = 0; k < threads; ++k) {
+		const char *stop = end;
+		if (k + 1 < threads) {
+			stop = body + len / (size_t)threads * (size_t)(k + 1);
+			if (stop < cut) stop = cut;
+			const char *nl = (const char *)memchr(stop, '\n', (size_t)(end - stop));
+			stop = nl ? nl + 1 : end;
+		}
+		chunks[k].begin = cut;
+		chunks[k].end = stop;
+		chunks[k].kernel = kernel;
+		cut = stop;
+	}
+	parallel_run(chunks, sizeof(ParseChunk), threads, parse_chunk_worker, 1);
+
+	// Anything unusual (malformed input, even past the declared clause count,
+	// or a failed allocation) goes through the sequential parser, so both
+	// modes always agree
+	int ok = 1;
+	for (int k = 0; k < threads && ok; ++k) {
+		if (chunks[k].status < 0) ok = 0;
+		else if (chunks[k].status == 1) break;
+	}
+	memset(out, 0, sizeof(*out));
+	out->num_variables = num_vars;
+	SizeFix fixes[PARSE_MAX_THREADS + 1];
+	int num_fixes = 0;
+	int used = threads;
+	size_t total = 0;
+	if (!ok || plan_stitch(chunks, &used, out, fixes, &num_fixes, &total) != 0 ||
+		arena_init(&out->arena, total) != 0) {
+		free_chunks(chunks, threads);
+		free_opt_cnf(out);
+		return parse_cnf_buffer_opt(data, size, out);
+	}
+	for (int k = 0; k < used; ++k) chunks[k].target = &out->arena;
+	parallel_run(chunks, sizeof(ParseChunk), used, copy_chunk_worker, 1);
+	out->arena.size = (uint32_t)total;
+	for (int f = 0; f < num_fixes; ++f) arena_clause(&out->arena, fixes[f].ref)->size = fixes[f].size;
+	free_chunks(chunks, threads);
+	// Clauses past the declared count are dropped like the sequential parser does
+	if (out->num_clauses > num_clauses) out->num_clauses = num_clauses;
+	return 0;
+}
+
+int parse_cnf_file_parallel(const char *path, OptCNF *out, int threads) {
+	if (!path || !out) return -1;
+	// Decompression is the bottleneck there; chunking would not help
+	if (cnf_stream_needed(path)) return parse_cnf_file_stream(path, out);
+	CnfInput in;
+	if (cnf_input_open(path, &in) != 0) return -1;
+	int r = parse_cnf_buffer_parallel(in.data, in.size, out, threads);
+	cnf_input_close(&in);
+	return r;
+}
@@ -0,0 +1,181 @@
+#include "parser_simd.h"
+#include <string.h>
+#include <limits.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define PARSER_HAVE_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
+const char *parse_kernel_name(ParseKernel kernel) {
+	switch (kernel) {
+	case PARSE_KERNEL_AVX2: return "avx2";
+	case PARSE_KERNEL_SSE42: return "sse4.2";
+	case PARSE_KERNEL_SCALAR:
+	default: return "scalar";
+	}
+}
+
+#ifdef PARSER_HAVE_X86_SIMD
+
+ParseKernel parse_kernel_detect(void) {
+	static int detected = -1;
+	if (detected < 0) {
+		__builtin_cpu_init();
+		if (__builtin_cpu_supports("avx2")) detected = PARSE_KERNEL_AVX2;
+		else if (__builtin_cpu_supports("sse4.2")) detected = PARSE_KERNEL_SSE42;
+		else detected = PARSE_KERNEL_SCALAR;
+	}
+	return (ParseKernel)detected;
+}
+
+// Bit i set if p[i] is whitespace or a control byte (unsigned <= ' ')
+typedef uint64_t (*SpaceMaskFn)(const char *p);
+
+__attribute__((target("avx2")))
+static uint64_t space_mask_avx2(const char *p) {
+	const __m256i sp = _mm256_set1_epi8(' ');
+	__m256i a = _mm256_loadu_si256((const __m256i *)p);
+	__m256i b = _mm256_loadu_si256((const __m256i *)(p + 32));
+	uint32_t ma = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_max_epu8(a, sp), sp));
+	uint32_t mb = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_max_epu8(b, sp), sp));
+	return (uint64_t)ma | ((uint64_t)mb << 32);
+}
+
+__attribute__((target("sse4.2")))
+static uint64_t space_mask_sse42(const char *p) {
+	const __m128i sp = _mm_set1_epi8(' ');
+	uint64_t m = 0;
+	for (int k = 0; k < 4; ++k) {
+		__m128i v = _mm_loadu_si128((const __m128i *)(p + 16 * k));
+		m |= (uint64_t)(uint16_t)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_max_epu8(v, sp), sp)) << (16 * k);
+	}
+	return m;
+}
+
+// pshufb controls that right-align n leading digits in a 16-byte lane and
+// zero the rest (0x80 clears a byte)
+static const uint8_t digit_align[11][16] __attribute__((aligned(16))) = {
+	{0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80},
+	{0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0},
+	{0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0,1},
+	{0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0,1,2},
+	{0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0,1,2,3},
+	{0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0,1,2,3,4},
+	{0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0,1,2,3,4,5},
+	{0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0,1,2,3,4,5,6},
+	{0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0,1,2,3,4,5,6,7},
+	{0x80,0x80,0x80,0x80,0x80,0x80,0x80,0,1,2,3,4,5,6,7,8},
+	{0x80,0x80,0x80,0x80,0x80,0x80,0,1,2,3,4,5,6,7,8,9}
+};
+
+// Convert a run of n (1..10) ASCII digits to an integer in one pass:
+// validate all digits at once, right-align them, then combine pairs, quads
+// and octets with multiply-adds. Returns -1 on a non-digit or overflow.
+__attribute__((target("sse4.2")))
+static inline int convert_digits(const char *s, size_t n, const char *limit, int *out) {
+	char tmp[16];
+	if (s + 16 > limit) {
+		memset(tmp, '0', sizeof(tmp));
+		memcpy(tmp, s, n);
+		s = tmp;
+	}
+	__m128i d = _mm_sub_epi8(_mm_loadu_si128((const __m128i *)s), _mm_set1_epi8('0'));
+	unsigned ok = (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_min_epu8(d, _mm_set1_epi8(9)), d));
+	unsigned need = (1u << n) - 1;
+	if ((ok & need) != need) return -1;
+	d = _mm_shuffle_epi8(d, _mm_load_si128((const __m128i *)digit_align[n]));
+	__m128i pairs = _mm_maddubs_epi16(d, _mm_setr_epi8(10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1));
+	__m128i quads = _mm_madd_epi16(pairs, _mm_setr_epi16(100, 1, 100, 1, 100, 1, 100, 1));
+	quads = _mm_packus_epi32(quads, quads);
+	__m128i octs = _mm_madd_epi16(quads, _mm_setr_epi16(10000, 1, 10000, 1, 10000, 1, 10000, 1));
+	uint64_t hi = (uint32_t)_mm_cvtsi128_si32(octs);
+	uint64_t lo = (uint32_t)_mm_extract_epi32(octs, 1);
+	uint64_t v = hi * 100000000ULL + lo;
+	if (v > (uint64_t)INT_MAX) return -1;
+	*out = (int)v;
+	return 0;
+}
+
+static const char *skip_line_simd(const char *p, const char *end) {
+	const char *nl = (const char *)memchr(p, '\n', (size_t)(end - p));
+	return nl ? nl + 1 : end;
+}
+
+// Walk the input in 64-byte windows. Each window is classified into a
+// whitespace bitmask by the vector kernel; token starts are the non-space
+// bytes preceded by whitespace and are visited with bit scans, so the scalar
+// code only runs once per token instead of once per byte.
+__attribute__((target("sse4.2")))
+static int scan_windows(SpaceMaskFn space_mask, const char *p, const char *end, OptCNF *out, size_t num_clauses,
+	ClauseRef *open) {
+	ClauseArena *arena = &out->arena;
+	const char *next = p;   // tokens starting before this were consumed already
+	uint64_t carry = 1;     // the byte before p ends the header line
+	char pad[64];
+	for (const char *base = p; base < end && out->num_clauses < num_clauses; base += 64) {
+		uint64_t S;
+		if (end - base >= 64) {
+			S = space_mask(base);
+		} else {
+			memset(pad, ' ', sizeof(pad));
+			memcpy(pad, base, (size_t)(end - base));
+			S = space_mask(pad);
+		}
+		uint64_t starts = ~S & ((S << 1) | carry);
+		carry = S >> 63;
+		while (starts) {
+			unsigned i = (unsigned)__builtin_ctzll(starts);
+			starts &= starts - 1;
+			const char *tok = base + i;
+			if (tok < next) continue;
+			size_t len;
+			uint64_t after = S >> i;
+			if (after) {
+				len = (size_t)__builtin_ctzll(after);
+			} else {
+				// Token runs past the window
+				const char *q = base + 64;
+				while (q < end && (unsigned char)*q > ' ') q++;
+				len = (size_t)(q - tok);
+			}
+			next = tok + len;
+			char c = *tok;
+			if (c == 'c' || c == 'C') { next = skip_line_simd(tok, end); continue; }
+			if (c == '%') return 1; // SATLIB end marker
+			int neg = (c == '-');
+			size_t sign = (size_t)(neg || c == '+');
+			int v;
+			if (len - sign == 0 || len - sign > 10 || convert_digits(tok + sign, len - sign, end, &v) != 0) {
+				return -1;
+			}
+			if (v == 0) {
+				if (scan_close_clause(out, open) != 0) return -1;
+				if (out->num_clauses == num_clauses) return 0;
+				continue;
+			}
+			if (scan_push_lit(arena, open, neg ? -v : v) != 0) return -1;
+		}
+	}
+	return 0;
+}
+
+int simd_scan_clauses(ParseKernel kernel, const char *p, const char *end, OptCNF *out, size_t num_clauses,
+	ClauseRef *open) {
+	SpaceMaskFn fn = kernel == PARSE_KERNEL_AVX2 ? space_mask_avx2 : space_mask_sse42;
+	return scan_windows(fn, p, end, out, num_clauses, open);
+}
+
+#else
+
+ParseKernel parse_kernel_detect(void) {
+	return PARSE_KERNEL_SCALAR;
+}
+
+int simd_scan_clauses(ParseKernel kernel, const char *p, const char *end, OptCNF *out, size_t num_clauses,
+	ClauseRef *open) {
+	(void)kernel; (void)p; (void)end; (void)out; (void)num_clauses; (void)open;
+	return -1;
+}
+
+#endif
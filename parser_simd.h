@@ -0,0 +1,62 @@
+// parser_simd.h - DIMACS clause scanners shared by the parser_opt parsers (internal)
+#ifndef SAT_PARSER_SIMD_H
+#define SAT_PARSER_SIMD_H
+
+#include "parser_opt.h"
+
+// Clause assembly shared by the scalar and vector scanners. '*open' is the
+// clause being filled, CLAUSE_REF_UNDEF between clauses.
+static inline void scan_open_clause(ClauseArena *arena, ClauseRef *open) {
+	*open = arena->size;
+	ArenaClause *cl = arena_clause(arena, *open);
+	cl->flags = 0;
+	cl->lbd = 0;
+	cl->u.activity = 0.0f;
+	arena->size += ARENA_HEADER_WORDS;
+}
+
+static inline int scan_push_lit(ClauseArena *arena, ClauseRef *open, int lit) {
+	if (arena->cap - arena->size < ARENA_HEADER_WORDS + 1 && arena_reserve(arena, ARENA_HEADER_WORDS + 1) != 0) {
+		return -1;
+	}
+	if (*open == CLAUSE_REF_UNDEF) scan_open_clause(arena, open);
+	arena->mem[arena->size++] = (uint32_t)lit;
+	return 0;
+}
+
+// Called at every terminating 0; a 0 with no clause open is the empty clause
+static inline int scan_close_clause(OptCNF *out, ClauseRef *open) {
+	ClauseArena *arena = &out->arena;
+	if (*open == CLAUSE_REF_UNDEF) {
+		if (arena->cap - arena->size < ARENA_HEADER_WORDS && arena_reserve(arena, ARENA_HEADER_WORDS) != 0) return -1;
+		scan_open_clause(arena, open);
+	}
+	if (out->num_clauses == out->clauses_cap) {
+		size_t new_cap = out->clauses_cap ? out->clauses_cap * 2 : 256;
+		ClauseRef *arr = (ClauseRef *)realloc(out->clauses, new_cap * sizeof(ClauseRef));
+		if (!arr) return -1;
+		out->clauses = arr;
+		out->clauses_cap = new_cap;
+	}
+	arena_clause(arena, *open)->size = arena->size - *open - ARENA_HEADER_WORDS;
+	out->clauses[out->num_clauses++] = *open;
+	*open = CLAUSE_REF_UNDEF;
+	return 0;
+}
+
+// Find and parse "p cnf <vars> <clauses>". Returns the position after the
+// header line, or NULL if there is none.
+const char *scan_header(const char *p, const char *end, int *num_vars, size_t *num_clauses);
+
+// Scan clause lines in [p, end), which must start at a line start, until
+// num_clauses are complete. The last clause may be left open in '*open'.
+// Returns 0 at the end of the input or clause count, 1 at a SATLIB '%' end
+// marker, -1 on malformed input or allocation failure.
+int scan_clauses(ParseKernel kernel, const char *p, const char *end, OptCNF *out, size_t num_clauses,
+	ClauseRef *open);
+
+// scan_clauses for a vector kernel (not PARSE_KERNEL_SCALAR)
+int simd_scan_clauses(ParseKernel kernel, const char *p, const char *end, OptCNF *out, size_t num_clauses,
+	ClauseRef *open);
+
+#endif // SAT_PARSER_SIMD_H
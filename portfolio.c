@@ -0,0 +1,142 @@
+#include "portfolio.h"
+#include "parallel.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct PortfolioShared {
+	const OptCNF *cnf;
+	long timeout_ms;
+	volatile int stop;      // set by the first thread with an answer
+	pthread_mutex_t lock;
+	int winner;
+} PortfolioShared;
+
+typedef struct PortfolioWorker {
+	PortfolioShared *shared;
+	int index;
+	Assignment model;
+	PortfolioThreadStats st;
+} PortfolioWorker;
+
+void portfolio_thread_options(const SolverOptions *base, int index, SolverOptions *opts) {
+	*opts = *base;
+	opts->stop = NULL;
+	opts->exchange = NULL;
+	opts->exchange_id = 0;
+	opts->proof = NULL;
+	if (index <= 0) return;
+	unsigned long long seed = base->seed ? base->seed : 0x9E3779B97F4A7C15ULL;
+	opts->seed = seed + (unsigned long long)index * 0xBF58476D1CE4E5B9ULL;
+	if (opts->seed == 0) opts->seed = 1;
+	// Eight basic configurations; later rounds repeat them from a shuffled
+	// variable order with a slightly slower VSIDS decay
+	switch (index % 8) {
+	case 0: break;
+	case 1: opts->phase = PHASE_TARGET; break;
+	case 2: opts->restart = RESTART_LUBY; opts->initial_phase = 1; break;
+	case 3: opts->phase = PHASE_BEST; opts->var_decay = 0.90; break;
+	case 4: opts->phase = PHASE_RANDOM; break;
+	case 5: opts->phase = PHASE_TARGET; opts->restart = RESTART_LUBY; opts->luby_unit = 512; break;
+	case 6: opts->shuffle_order = 1; opts->var_decay = 0.85; opts->initial_phase = 1; break;
+	case 7: opts->decision = DECIDE_STATIC; opts->restart = RESTART_LUBY; break;
+	}
+	int round = index / 8;
+	if (round > 0) {
+		opts->shuffle_order = 1;
+		opts->var_decay += 0.01 * (double)(round % 4);
+		if (opts->var_decay >= 0.99) opts->var_decay = 0.99;
+	}
+}
+
+const char *portfolio_describe(const SolverOptions *opts, char *buf, size_t size) {
+	static const char *const phases[] = {"saved", "false", "true", "random", "target", "best"};
+	static const char *const restarts[] = {"glucose", "luby", "none"};
+	int ph = (int)opts->phase >= 0 && (int)opts->phase <= PHASE_BEST ? (int)opts->phase : 0;
+	int rs = (int)opts->restart >= 0 && (int)opts->restart <= RESTART_NONE ? (int)opts->restart : 0;
+	snprintf(buf, size, "%s/%s/%s%s", opts->decision == DECIDE_STATIC ? "static" : "vsids",
+		phases[ph], restarts[rs], opts->shuffle_order ? "/shuffled" : "");
+	return buf;
+}
+
+static void *portfolio_worker(void *arg) {
+	PortfolioWorker *w = (PortfolioWorker *)arg;
+	PortfolioShared *sh = w->shared;
+	w->st.result = cdcl_solve_opt(sh->cnf, &w->model, &w->st.opts, &w->st.stats, sh->timeout_ms, &w->st.ms);
+	if (w->st.result == 0 || w->st.result == 1) {
+		pthread_mutex_lock(&sh->lock);
+		if (sh->winner < 0) {
+			sh->winner = w->index;
+			sh->stop = 1;
+		}
+		pthread_mutex_unlock(&sh->lock);
+	}
+	return NULL;
+}
+
+int portfolio_solve(const OptCNF *cnf, Assignment *model, const SolverOptions *base, int threads,
+	const ExchangeOptions *share, long timeout_ms, PortfolioThreadStats *per_thread, int *out_threads,
+	int *winner, double *out_time_ms) {
+	if (out_threads) *out_threads = 0;
+	if (winner) *winner = -1;
+	if (!cnf || !model) return -2;
+	double start = wall_ms();
+	SolverOptions defaults;
+	if (!base) {
+		solver_default_options(&defaults);
+		base = &defaults;
+	}
+	if (threads <= 0) threads = cpu_count();
+	if (threads > PORTFOLIO_MAX_THREADS) threads = PORTFOLIO_MAX_THREADS;
+
+	PortfolioShared sh;
+	sh.cnf = cnf;
+	sh.timeout_ms = timeout_ms;
+	sh.stop = 0;
+	sh.winner = -1;
+	ClauseExchange exchange;
+	int sharing = share && threads > 1;
+	if (sharing && exchange_init(&exchange, threads, share) != 0) return -2;
+	PortfolioWorker *workers = (PortfolioWorker *)calloc((size_t)threads, sizeof(PortfolioWorker));
+	if (!workers || pthread_mutex_init(&sh.lock, NULL) != 0) {
+		free(workers);
+		if (sharing) exchange_free(&exchange);
+		return -2;
+	}
+	for (int i = 0; i < threads; ++i) {
+		workers[i].shared = &sh;
+		workers[i].index = i;
+		portfolio_thread_options(base, i, &workers[i].st.opts);
+		workers[i].st.opts.stop = &sh.stop;
+		if (sharing) {
+			workers[i].st.opts.exchange = &exchange;
+			workers[i].st.opts.exchange_id = i;
+		}
+	}
+
+	// The calling thread runs configuration 0; if a thread cannot be
+	// started the portfolio simply runs with fewer configurations
+	int started = parallel_run(workers, sizeof(PortfolioWorker), threads, portfolio_worker, 0);
+	pthread_mutex_destroy(&sh.lock);
+
+	int res = -2;
+	for (int i = 0; i < started; ++i) {
+		PortfolioWorker *w = &workers[i];
+		if (w->st.result == -1) res = -1;
+		if (w->st.result == 1 && i != sh.winner) free_assignment(&w->model);
+		w->st.opts.stop = NULL;
+		w->st.opts.exchange = NULL;
+		if (per_thread) per_thread[i] = w->st;
+	}
+	if (sh.winner >= 0) {
+		res = workers[sh.winner].st.result;
+		if (res == 1) *model = workers[sh.winner].model;
+	}
+	free(workers);
+	if (sharing) exchange_free(&exchange);
+	if (out_threads) *out_threads = started;
+	if (winner) *winner = sh.winner;
+	if (out_time_ms) *out_time_ms = wall_ms() - start;
+	return res;
+}
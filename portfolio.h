@@ -0,0 +1,35 @@
+// portfolio.h - several differently configured CDCL searches racing on one formula
+#ifndef SAT_PORTFOLIO_H
+#define SAT_PORTFOLIO_H
+
+#include "solver.h"
+#include "exchange.h"
+
+#define PORTFOLIO_MAX_THREADS 64
+
+typedef struct PortfolioThreadStats {
+	SolverOptions opts; // configuration the thread ran with
+	SolverStats stats;
+	int result;         // cdcl_solve_opt result; -1 also for threads cancelled by the winner
+	double ms;
+} PortfolioThreadStats;
+
+// Configuration of portfolio thread 'index': thread 0 runs 'base' unchanged,
+// the others vary phase and restart policies, decision heuristic, VSIDS decay
+// and seed
+void portfolio_thread_options(const SolverOptions *base, int index, SolverOptions *opts);
+
+// Run 'threads' searches (0 = one per CPU, at most PORTFOLIO_MAX_THREADS) on
+// the shared read-only 'cnf'; the first one to answer stops the others.
+// With 'share' (NULL = no sharing) the threads exchange short learned
+// clauses at restarts. Same contract as cdcl_solve_opt. 'winner' receives
+// the index of the answering thread (-1 if none), 'per_thread' (may be
+// NULL) one entry per thread started. Returns the number of threads through 'out_threads'.
+int portfolio_solve(const OptCNF *cnf, Assignment *model, const SolverOptions *base, int threads,
+	const ExchangeOptions *share, long timeout_ms, PortfolioThreadStats *per_thread, int *out_threads,
+	int *winner, double *out_time_ms);
+
+// Short description of a configuration, e.g. "vsids/target/glucose"
+const char *portfolio_describe(const SolverOptions *opts, char *buf, size_t size);
+
+#endif // SAT_PORTFOLIO_H
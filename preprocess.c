@@ -0,0 +1,903 @@
+#include "preprocess.h"
+#include "clause_arena.h"
+#include "literal.h"
+#include "proof.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// Clauses are numbered in the order they are added; per-clause tables are
+// indexed by that id and occurrence lists hold ids
+typedef struct IdVec {
+	uint32_t *data;
+	uint32_t size;
+	uint32_t capacity;
+} IdVec;
+
+typedef struct Pre {
+	int num_vars;
+	PreprocessOptions opts;
+	PreprocessStats stats;
+	ElimStack *elim;
+
+	ClauseArena arena;      // packed literals; removed clauses carry ARENA_CLAUSE_DELETED
+	ClauseRef *refs;        // per clause id
+	uint64_t *sigs;         // per clause id: bit (var & 63) for every variable
+	unsigned char *queued;  // per clause id: waiting in 'queue'
+	uint32_t num_clauses;
+	uint32_t clauses_cap;
+	size_t live_clauses;
+
+	IdVec *occ;             // per variable; may still list removed clauses
+	int8_t *vals;           // per literal, top-level assignment
+	unsigned char *eliminated; // per variable
+	uint32_t *stamp;        // per literal, marks of the clause being compared
+	uint32_t cur_stamp;
+	int *units;             // top-level trail
+	int units_head;
+	int units_size;
+
+	IdVec *watches;         // per literal, only while probing
+	int *trail;             // probe assignments, undone after each probe
+	int trail_size;
+	int trail_head;
+
+	IdVec queue;            // clauses to use for backward subsumption
+	IdVec scan;             // copy of the occurrence list being walked
+	IdVec pos, neg;
+	int *tmp;               // literal scratch (resolvents)
+	size_t tmp_size;
+	size_t tmp_cap;
+
+	unsigned long budget;
+	int unsat;
+} Pre;
+
+void preprocess_default_options(PreprocessOptions *opts) {
+	if (!opts) return;
+	opts->eliminate = 1;
+	opts->resolvent_limit = 20;
+	opts->clause_growth = 0;
+	opts->budget = 200000000UL;
+	opts->probe = 1;
+	opts->substitute = 1;
+	opts->probe_ms = 200;
+	opts->proof = NULL;
+}
+
+static int idvec_push(IdVec *v, uint32_t x) {
+	if (v->size == v->capacity) {
+		uint32_t new_cap = v->capacity ? v->capacity * 2 : 8;
+		uint32_t *arr = (uint32_t *)realloc(v->data, new_cap * sizeof(uint32_t));
+		if (!arr) return -1;
+		v->data = arr;
+		v->capacity = new_cap;
+	}
+	v->data[v->size++] = x;
+	return 0;
+}
+
+static void idvec_remove(IdVec *v, uint32_t x) {
+	for (uint32_t i = 0; i < v->size; ++i) {
+		if (v->data[i] == x) {
+			v->data[i] = v->data[--v->size];
+			return;
+		}
+	}
+}
+
+static int idvec_copy(IdVec *dst, const IdVec *src) {
+	dst->size = 0;
+	for (uint32_t i = 0; i < src->size; ++i) {
+		if (idvec_push(dst, src->data[i]) != 0) return -1;
+	}
+	return 0;
+}
+
+static int tmp_push(Pre *p, int x) {
+	if (p->tmp_size == p->tmp_cap) {
+		size_t new_cap = p->tmp_cap ? p->tmp_cap * 2 : 256;
+		int *arr = (int *)realloc(p->tmp, new_cap * sizeof(int));
+		if (!arr) return -1;
+		p->tmp = arr;
+		p->tmp_cap = new_cap;
+	}
+	p->tmp[p->tmp_size++] = x;
+	return 0;
+}
+
+static int elim_push(ElimStack *e, int x) {
+	if (e->size == e->capacity) {
+		size_t new_cap = e->capacity ? e->capacity * 2 : 1024;
+		int *arr = (int *)realloc(e->data, new_cap * sizeof(int));
+		if (!arr) return -1;
+		e->data = arr;
+		e->capacity = new_cap;
+	}
+	e->data[e->size++] = x;
+	return 0;
+}
+
+// DRAT lines, when a proof is being written
+static void log_add(Pre *p, const int *lits, uint32_t n) {
+	if (p->opts.proof) proof_add(p->opts.proof, lits, (int)n, NULL, 0);
+}
+
+static void log_delete(Pre *p, const int *lits, uint32_t n) {
+	if (p->opts.proof) proof_delete(p->opts.proof, lits, (int)n, 0);
+}
+
+static inline ArenaClause *pclause(const Pre *p, uint32_t id) {
+	return arena_clause(&p->arena, p->refs[id]);
+}
+
+static inline int is_deleted(const Pre *p, uint32_t id) {
+	return (pclause(p, id)->flags & ARENA_CLAUSE_DELETED) != 0;
+}
+
+static uint64_t clause_sig(const ArenaClause *c) {
+	uint64_t sig = 0;
+	for (uint32_t i = 0; i < c->size; ++i) sig |= 1ULL << (lit_var(c->lits[i]) & 63);
+	return sig;
+}
+
+static void next_stamp(Pre *p) {
+	if (++p->cur_stamp == 0) {
+		memset(p->stamp, 0, (size_t)(2 * p->num_vars + 2) * sizeof(uint32_t));
+		p->cur_stamp = 1;
+	}
+}
+
+static void enqueue_clause(Pre *p, uint32_t id) {
+	if (p->queued[id]) return;
+	if (idvec_push(&p->queue, id) != 0) { p->unsat = -2; return; }
+	p->queued[id] = 1;
+}
+
+static void assign(Pre *p, int lit) {
+	if (p->vals[lit] == LIT_TRUE) return;
+	if (p->vals[lit] == LIT_FALSE) { p->unsat = 1; return; }
+	p->vals[lit] = LIT_TRUE;
+	p->vals[lit_not(lit)] = LIT_FALSE;
+	p->units[p->units_size++] = lit;
+	p->stats.fixed_vars++;
+}
+
+static void delete_clause(Pre *p, uint32_t id) {
+	ArenaClause *c = pclause(p, id);
+	if (c->flags & ARENA_CLAUSE_DELETED) return;
+	// Units stay in the proof: checkers ignore their deletion anyway
+	if (c->size > 1) log_delete(p, c->lits, c->size);
+	arena_delete(&p->arena, p->refs[id]);
+	p->live_clauses--;
+}
+
+// Drop 'lit' from clause 'id' (it is false or was resolved away)
+static void remove_lit(Pre *p, uint32_t id, int lit) {
+	ArenaClause *c = pclause(p, id);
+	uint32_t at = 0, j = 0;
+	while (at < c->size && c->lits[at] != lit) ++at;
+	// Occurrence lists of assigned variables may still name clauses that lost it
+	if (at == c->size) return;
+	if (p->opts.proof) {
+		// Move lit to the end to log the shorter clause, then the one it replaces
+		c->lits[at] = c->lits[c->size - 1];
+		c->lits[c->size - 1] = lit;
+		log_add(p, c->lits, c->size - 1);
+		if (c->size > 1) log_delete(p, c->lits, c->size);
+	}
+	for (uint32_t i = 0; i < c->size; ++i) {
+		if (c->lits[i] != lit) c->lits[j++] = c->lits[i];
+	}
+	c->size = j;
+	p->sigs[id] = clause_sig(c);
+	// The lists of assigned variables are dropped as a whole by propagate_units
+	if (p->vals[lit] == LIT_UNDEF) idvec_remove(&p->occ[lit_var(lit)], id);
+	if (j == 0) p->unsat = 1;
+	else if (j == 1) assign(p, c->lits[0]);
+	enqueue_clause(p, id);
+}
+
+// Add a clause of packed literals: duplicates, tautologies and assigned
+// literals are handled here, units go to the trail. A 'derived' clause is
+// logged as a lemma; an input clause only if it had to be shortened.
+static int add_clause(Pre *p, const int *lits, uint32_t n, int derived) {
+	next_stamp(p);
+	uint32_t m = 0;
+	int buf_small[32];
+	int *buf = n <= 32 ? buf_small : (int *)malloc(n * sizeof(int));
+	if (!buf) return -2;
+	for (uint32_t i = 0; i < n; ++i) {
+		int l = lits[i];
+		if (p->vals[l] == LIT_TRUE || p->stamp[lit_not(l)] == p->cur_stamp) { m = UINT32_MAX; break; }
+		if (p->vals[l] == LIT_FALSE || p->stamp[l] == p->cur_stamp) continue;
+		p->stamp[l] = p->cur_stamp;
+		buf[m++] = l;
+	}
+	int r = 0;
+	if (m != UINT32_MAX && (derived || m != n)) log_add(p, buf, m);
+	if (m == UINT32_MAX) {
+		// satisfied or tautological
+	} else if (m == 0) {
+		p->unsat = 1;
+	} else if (m == 1) {
+		assign(p, buf[0]);
+	} else {
+		if (p->num_clauses == p->clauses_cap) {
+			uint32_t new_cap = p->clauses_cap ? p->clauses_cap * 2 : 1024;
+			ClauseRef *refs = (ClauseRef *)realloc(p->refs, new_cap * sizeof(ClauseRef));
+			if (refs) p->refs = refs;
+			uint64_t *sigs = (uint64_t *)realloc(p->sigs, new_cap * sizeof(uint64_t));
+			if (sigs) p->sigs = sigs;
+			unsigned char *queued = (unsigned char *)realloc(p->queued, new_cap);
+			if (queued) p->queued = queued;
+			if (!refs || !sigs || !queued) { r = -2; goto done; }
+			p->clauses_cap = new_cap;
+		}
+		ClauseRef ref = arena_alloc(&p->arena, buf, m);
+		if (ref == CLAUSE_REF_UNDEF) { r = -2; goto done; }
+		uint32_t id = p->num_clauses++;
+		p->refs[id] = ref;
+		p->sigs[id] = clause_sig(pclause(p, id));
+		p->queued[id] = 0;
+		p->live_clauses++;
+		for (uint32_t i = 0; i < m; ++i) {
+			if (idvec_push(&p->occ[lit_var(buf[i])], id) != 0) { r = -2; goto done; }
+		}
+		enqueue_clause(p, id);
+	}
+done:
+	if (buf != buf_small) free(buf);
+	return r;
+}
+
+// Apply the top-level units found so far to every clause they touch
+static void propagate_units(Pre *p) {
+	while (p->units_head < p->units_size && !p->unsat) {
+		int lit = p->units[p->units_head++];
+		if (idvec_copy(&p->scan, &p->occ[lit_var(lit)]) != 0) { p->unsat = -2; return; }
+		for (uint32_t k = 0; k < p->scan.size && !p->unsat; ++k) {
+			uint32_t id = p->scan.data[k];
+			if (is_deleted(p, id)) continue;
+			ArenaClause *c = pclause(p, id);
+			int has_lit = 0;
+			for (uint32_t i = 0; i < c->size; ++i) {
+				if (c->lits[i] == lit) { has_lit = 1; break; }
+			}
+			if (has_lit) delete_clause(p, id);
+			else remove_lit(p, id, lit_not(lit));
+		}
+		p->occ[lit_var(lit)].size = 0;
+	}
+}
+
+// Use clause 'id' to remove the clauses it subsumes and to strengthen those
+// it resolves with on a single literal (self-subsuming resolution)
+static void backward_subsume(Pre *p, uint32_t id) {
+	ArenaClause *c = pclause(p, id);
+	uint32_t n = c->size;
+	int best = lit_var(c->lits[0]);
+	for (uint32_t i = 1; i < n; ++i) {
+		int v = lit_var(c->lits[i]);
+		if (p->occ[v].size < p->occ[best].size) best = v;
+	}
+	uint64_t sig = p->sigs[id];
+	next_stamp(p);
+	for (uint32_t i = 0; i < n; ++i) p->stamp[c->lits[i]] = p->cur_stamp;
+	if (idvec_copy(&p->scan, &p->occ[best]) != 0) { p->unsat = -2; return; }
+	for (uint32_t k = 0; k < p->scan.size && p->budget > 0; ++k) {
+		uint32_t other = p->scan.data[k];
+		if (other == id || is_deleted(p, other)) continue;
+		ArenaClause *d = pclause(p, other);
+		if (d->size < n || (sig & ~p->sigs[other]) != 0) continue;
+		p->budget -= p->budget > d->size ? d->size : p->budget;
+		uint32_t same = 0, flips = 0;
+		int flipped = 0;
+		for (uint32_t i = 0; i < d->size; ++i) {
+			int l = d->lits[i];
+			if (p->stamp[l] == p->cur_stamp) same++;
+			else if (p->stamp[lit_not(l)] == p->cur_stamp) { flips++; flipped = l; }
+		}
+		if (same == n) {
+			delete_clause(p, other);
+			p->stats.subsumed++;
+		} else if (same + 1 == n && flips == 1) {
+			remove_lit(p, other, flipped);
+			p->stats.strengthened++;
+			if (p->unsat) return;
+		}
+	}
+}
+
+static void subsumption_round(Pre *p) {
+	for (uint32_t k = 0; k < p->queue.size && !p->unsat; ++k) {
+		uint32_t id = p->queue.data[k];
+		p->queued[id] = 0;
+		if (is_deleted(p, id) || p->budget == 0) continue;
+		backward_subsume(p, id);
+		propagate_units(p);
+	}
+	for (uint32_t k = 0; k < p->queue.size; ++k) p->queued[p->queue.data[k]] = 0;
+	p->queue.size = 0;
+}
+
+// Split the live clauses of var into pos/neg, dropping removed ones from its list
+static int collect_occurrences(Pre *p, int var) {
+	IdVec *o = &p->occ[var];
+	int pl = mk_lit(var, 0);
+	p->pos.size = 0;
+	p->neg.size = 0;
+	uint32_t j = 0;
+	for (uint32_t k = 0; k < o->size; ++k) {
+		uint32_t id = o->data[k];
+		if (is_deleted(p, id)) continue;
+		o->data[j++] = id;
+		ArenaClause *c = pclause(p, id);
+		int positive = 0;
+		for (uint32_t i = 0; i < c->size; ++i) {
+			if (c->lits[i] == pl) { positive = 1; break; }
+		}
+		if (idvec_push(positive ? &p->pos : &p->neg, id) != 0) return -1;
+	}
+	o->size = j;
+	return 0;
+}
+
+// Resolve the clause marked in 'stamp' (containing pivot) with 'id' on the
+// pivot. Returns the resolvent size, -1 if it is a tautology. With 'out'
+// set the resolvent's literals are appended to p->tmp.
+static int resolve(Pre *p, uint32_t mark_size, uint32_t id, int pivot, int out) {
+	ArenaClause *d = pclause(p, id);
+	int size = (int)mark_size - 1;
+	for (uint32_t i = 0; i < d->size; ++i) {
+		int l = d->lits[i];
+		if (l == lit_not(pivot)) continue;
+		if (p->stamp[lit_not(l)] == p->cur_stamp) return -1;
+		if (p->stamp[l] != p->cur_stamp) {
+			size++;
+			if (out && tmp_push(p, l) != 0) { p->unsat = -2; return -1; }
+		}
+	}
+	return size;
+}
+
+static void mark_clause(Pre *p, uint32_t id) {
+	ArenaClause *c = pclause(p, id);
+	next_stamp(p);
+	for (uint32_t i = 0; i < c->size; ++i) p->stamp[c->lits[i]] = p->cur_stamp;
+}
+
+// Eliminate var by clause distribution if that does not increase the number
+// of clauses (beyond clause_growth) nor create long resolvents.
+// Returns 1 if eliminated, 0 if kept, -2 on error.
+static int try_eliminate(Pre *p, int var) {
+	if (collect_occurrences(p, var) != 0) return -2;
+	uint32_t np = p->pos.size, nn = p->neg.size;
+	if (np == 0 && nn == 0) return 0;
+	long limit = (long)np + (long)nn + p->opts.clause_growth;
+	long count = 0;
+	int pl = mk_lit(var, 0);
+	for (uint32_t a = 0; a < np; ++a) {
+		mark_clause(p, p->pos.data[a]);
+		uint32_t asize = pclause(p, p->pos.data[a])->size;
+		for (uint32_t b = 0; b < nn; ++b) {
+			if (p->budget == 0) return 0;
+			p->budget--;
+			int r = resolve(p, asize, p->neg.data[b], pl, 0);
+			if (r < 0) continue;
+			if (r > p->opts.resolvent_limit || ++count > limit) return 0;
+		}
+	}
+
+	// Keep the smaller side for model reconstruction, plus the default value
+	IdVec *side = np <= nn ? &p->pos : &p->neg;
+	int pivot = np <= nn ? pl : lit_not(pl);
+	for (uint32_t k = 0; k < side->size; ++k) {
+		ArenaClause *c = pclause(p, side->data[k]);
+		if (elim_push(p->elim, lit_to_dimacs(pivot)) != 0) return -2;
+		for (uint32_t i = 0; i < c->size; ++i) {
+			if (c->lits[i] != pivot && elim_push(p->elim, lit_to_dimacs(c->lits[i])) != 0) return -2;
+		}
+		if (elim_push(p->elim, (int)c->size) != 0) return -2;
+	}
+	if (elim_push(p->elim, lit_to_dimacs(lit_not(pivot))) != 0 || elim_push(p->elim, 1) != 0) return -2;
+
+	// Resolvents go to tmp as (size, literals...) records before the
+	// originals are removed, so adding them cannot disturb the occurrence lists
+	p->tmp_size = 0;
+	for (uint32_t a = 0; a < np; ++a) {
+		mark_clause(p, p->pos.data[a]);
+		ArenaClause *c = pclause(p, p->pos.data[a]);
+		uint32_t asize = c->size;
+		for (uint32_t b = 0; b < nn; ++b) {
+			size_t start = p->tmp_size;
+			if (tmp_push(p, 0) != 0) return -2;
+			c = pclause(p, p->pos.data[a]);
+			for (uint32_t i = 0; i < c->size; ++i) {
+				if (c->lits[i] != pl && tmp_push(p, c->lits[i]) != 0) return -2;
+			}
+			int r = resolve(p, asize, p->neg.data[b], pl, 1);
+			if (p->unsat) return -2;
+			if (r < 0) { p->tmp_size = start; continue; }
+			p->tmp[start] = r;
+		}
+	}
+	// Resolvents before the removal of their antecedents, as DRAT needs
+	size_t total = p->tmp_size;
+	for (size_t at = 0; at < total && !p->unsat;) {
+		uint32_t n = (uint32_t)p->tmp[at];
+		if (add_clause(p, p->tmp + at + 1, n, 1) != 0) return -2;
+		at += 1 + n;
+		p->stats.resolvents++;
+	}
+	for (uint32_t k = 0; k < np; ++k) delete_clause(p, p->pos.data[k]);
+	for (uint32_t k = 0; k < nn; ++k) delete_clause(p, p->neg.data[k]);
+	p->occ[var].size = 0;
+	p->eliminated[var] = 1;
+	p->stats.eliminated_vars++;
+	return 1;
+}
+
+static int cmp_by_cost(const void *a, const void *b) {
+	const uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+	return (x > y) - (x < y);
+}
+
+// Try every variable once, cheapest (fewest occurrences) first
+static int elimination_round(Pre *p) {
+	int nv = p->num_vars;
+	uint64_t *order = (uint64_t *)malloc((size_t)(nv + 1) * sizeof(uint64_t));
+	if (!order) return -2;
+	int count = 0;
+	for (int v = 1; v <= nv; ++v) {
+		if (p->eliminated[v] || p->vals[mk_lit(v, 0)] != LIT_UNDEF || p->occ[v].size == 0) continue;
+		order[count++] = ((uint64_t)p->occ[v].size << 32) | (uint32_t)v;
+	}
+	qsort(order, (size_t)count, sizeof(uint64_t), cmp_by_cost);
+	int eliminated = 0;
+	for (int k = 0; k < count && !p->unsat && p->budget > 0; ++k) {
+		int v = (int)(uint32_t)order[k];
+		if (p->eliminated[v] || p->vals[mk_lit(v, 0)] != LIT_UNDEF) continue;
+		int r = try_eliminate(p, v);
+		if (r < 0) { free(order); return -2; }
+		if (r == 1) {
+			eliminated++;
+			propagate_units(p);
+			subsumption_round(p);
+		}
+	}
+	free(order);
+	return eliminated;
+}
+
+// Two watched literals over the live clauses, kept only while probing
+static int build_watches(Pre *p) {
+	p->watches = (IdVec *)calloc((size_t)(2 * p->num_vars + 2), sizeof(IdVec));
+	if (!p->watches) return -1;
+	for (uint32_t id = 0; id < p->num_clauses; ++id) {
+		if (is_deleted(p, id)) continue;
+		ArenaClause *c = pclause(p, id);
+		if (c->size < 2) continue;
+		if (idvec_push(&p->watches[c->lits[0]], id) != 0 || idvec_push(&p->watches[c->lits[1]], id) != 0) return -1;
+	}
+	return 0;
+}
+
+static void free_watches(Pre *p) {
+	if (!p->watches) return;
+	for (int l = 0; l < 2 * p->num_vars + 2; ++l) free(p->watches[l].data);
+	free(p->watches);
+	p->watches = NULL;
+}
+
+static inline void probe_assign(Pre *p, int lit) {
+	p->vals[lit] = LIT_TRUE;
+	p->vals[lit_not(lit)] = LIT_FALSE;
+	p->trail[p->trail_size++] = lit;
+}
+
+static void probe_backtrack(Pre *p) {
+	while (p->trail_size > 0) {
+		int lit = p->trail[--p->trail_size];
+		p->vals[lit] = LIT_UNDEF;
+		p->vals[lit_not(lit)] = LIT_UNDEF;
+	}
+	p->trail_head = 0;
+}
+
+// Propagate the probe trail. Returns 0, -1 on conflict, -2 on error.
+static int probe_propagate(Pre *p) {
+	while (p->trail_head < p->trail_size) {
+		int f = lit_not(p->trail[p->trail_head++]);
+		IdVec *ws = &p->watches[f];
+		uint32_t i = 0, j = 0;
+		int r = 0;
+		for (; i < ws->size; ++i) {
+			uint32_t id = ws->data[i];
+			ArenaClause *c = pclause(p, id);
+			if (c->flags & ARENA_CLAUSE_DELETED) continue;
+			if (c->lits[0] == f) { c->lits[0] = c->lits[1]; c->lits[1] = f; }
+			if (p->vals[c->lits[0]] == LIT_TRUE) { ws->data[j++] = id; continue; }
+			uint32_t k = 2;
+			while (k < c->size && p->vals[c->lits[k]] == LIT_FALSE) ++k;
+			if (k < c->size) {
+				c->lits[1] = c->lits[k];
+				c->lits[k] = f;
+				if (idvec_push(&p->watches[c->lits[1]], id) != 0) { r = -2; ++i; break; }
+				continue;
+			}
+			ws->data[j++] = id;
+			if (p->vals[c->lits[0]] == LIT_FALSE) { r = -1; ++i; break; }
+			probe_assign(p, c->lits[0]);
+		}
+		for (; i < ws->size; ++i) ws->data[j++] = ws->data[i];
+		ws->size = j;
+		if (r != 0) return r;
+	}
+	return 0;
+}
+
+// Assign lit at the top level together with everything it implies
+static int probe_fix(Pre *p, int lit) {
+	if (p->vals[lit] == LIT_TRUE) return 0;
+	log_add(p, &lit, 1);
+	if (p->vals[lit] == LIT_FALSE) { p->unsat = 1; return -1; }
+	probe_assign(p, lit);
+	int r = probe_propagate(p);
+	if (r != 0) {
+		p->unsat = r == -1 ? 1 : -2;
+		return -1;
+	}
+	for (int i = 0; i < p->trail_size; ++i) {
+		if (i > 0) log_add(p, &p->trail[i], 1);
+		p->units[p->units_size++] = p->trail[i];
+	}
+	p->stats.fixed_vars += p->trail_size;
+	p->trail_size = 0;
+	p->trail_head = 0;
+	return 0;
+}
+
+// Probe both polarities of var: a conflict fixes the opposite literal, and
+// literals implied by both polarities are fixed as well
+static int probe_var(Pre *p, int var) {
+	int pl = mk_lit(var, 0);
+	p->stats.probes++;
+	probe_assign(p, pl);
+	int r = probe_propagate(p);
+	if (r == -2) { p->unsat = -2; return -1; }
+	if (r == -1) {
+		probe_backtrack(p);
+		p->stats.failed_literals++;
+		return probe_fix(p, lit_not(pl));
+	}
+	next_stamp(p);
+	for (int i = 1; i < p->trail_size; ++i) p->stamp[p->trail[i]] = p->cur_stamp;
+	probe_backtrack(p);
+
+	probe_assign(p, lit_not(pl));
+	r = probe_propagate(p);
+	if (r == -2) { p->unsat = -2; return -1; }
+	if (r == -1) {
+		probe_backtrack(p);
+		p->stats.failed_literals++;
+		return probe_fix(p, pl);
+	}
+	p->tmp_size = 0;
+	for (int i = 1; i < p->trail_size; ++i) {
+		if (p->stamp[p->trail[i]] == p->cur_stamp && tmp_push(p, p->trail[i]) != 0) { p->unsat = -2; return -1; }
+	}
+	probe_backtrack(p);
+	for (size_t k = 0; k < p->tmp_size; ++k) {
+		if (p->vals[p->tmp[k]] != LIT_UNDEF) continue;
+		p->stats.necessary++;
+		// Not a RUP unit by itself: log both implications first
+		int imp[2][2] = {{lit_not(pl), p->tmp[k]}, {pl, p->tmp[k]}};
+		log_add(p, imp[0], 2);
+		log_add(p, imp[1], 2);
+		int r = probe_fix(p, p->tmp[k]);
+		log_delete(p, imp[0], 2);
+		log_delete(p, imp[1], 2);
+		if (r != 0) return -1;
+	}
+	return 0;
+}
+
+static int probe_round(Pre *p) {
+	clock_t start = clock();
+	clock_t limit = (clock_t)((double)p->opts.probe_ms * CLOCKS_PER_SEC / 1000.0);
+	if (build_watches(p) != 0) { free_watches(p); return -2; }
+	for (int v = 1; v <= p->num_vars && !p->unsat; ++v) {
+		if (p->eliminated[v] || p->vals[mk_lit(v, 0)] != LIT_UNDEF || p->occ[v].size == 0) continue;
+		if (p->opts.probe_ms > 0 && (v & 15) == 0 && clock() - start > limit) break;
+		if (probe_var(p, v) != 0) break;
+	}
+	free_watches(p);
+	if (p->unsat < 0) return -2;
+	propagate_units(p);
+	return 0;
+}
+
+// Tarjan over the binary implication graph: each strongly connected
+// component is a set of equivalent literals, all replaced by the one with
+// the smallest variable. Returns the number of substituted variables.
+static int substitute_equivalences(Pre *p) {
+	int nv = p->num_vars;
+	int nl = 2 * nv + 2;
+	uint32_t *start = (uint32_t *)calloc((size_t)nl + 1, sizeof(uint32_t));
+	uint32_t *fill = (uint32_t *)malloc((size_t)nl * sizeof(uint32_t));
+	uint32_t *index = (uint32_t *)calloc((size_t)nl, sizeof(uint32_t));
+	uint32_t *low = (uint32_t *)malloc((size_t)nl * sizeof(uint32_t));
+	uint32_t *call_pos = (uint32_t *)malloc((size_t)nl * sizeof(uint32_t));
+	int *call = (int *)malloc((size_t)nl * sizeof(int));
+	int *stack = (int *)malloc((size_t)nl * sizeof(int));
+	int *repr = (int *)malloc((size_t)nl * sizeof(int));
+	unsigned char *on_stack = (unsigned char *)calloc((size_t)nl, 1);
+	int *edges = NULL;
+	int result = -2;
+	if (!start || !fill || !index || !low || !call_pos || !call || !stack || !repr || !on_stack) goto done;
+
+	// (a | b) gives the edges -a -> b and -b -> a
+	for (uint32_t id = 0; id < p->num_clauses; ++id) {
+		if (is_deleted(p, id) || pclause(p, id)->size != 2) continue;
+		const ArenaClause *c = pclause(p, id);
+		start[lit_not(c->lits[0]) + 1]++;
+		start[lit_not(c->lits[1]) + 1]++;
+	}
+	for (int l = 0; l < nl; ++l) start[l + 1] += start[l];
+	edges = (int *)malloc(((size_t)start[nl] + 1) * sizeof(int));
+	if (!edges) goto done;
+	memcpy(fill, start, (size_t)nl * sizeof(uint32_t));
+	for (uint32_t id = 0; id < p->num_clauses; ++id) {
+		if (is_deleted(p, id) || pclause(p, id)->size != 2) continue;
+		const ArenaClause *c = pclause(p, id);
+		edges[fill[lit_not(c->lits[0])]++] = c->lits[1];
+		edges[fill[lit_not(c->lits[1])]++] = c->lits[0];
+	}
+
+	for (int l = 0; l < nl; ++l) repr[l] = l;
+	uint32_t counter = 0;
+	int sp = 0;
+	for (int root = 2; root < nl; ++root) {
+		if (index[root] || start[root] == start[root + 1]) continue;
+		int depth = 0;
+		call[0] = root;
+		call_pos[0] = start[root];
+		index[root] = low[root] = ++counter;
+		stack[sp++] = root;
+		on_stack[root] = 1;
+		while (depth >= 0) {
+			int u = call[depth];
+			if (call_pos[depth] < start[u + 1]) {
+				int w = edges[call_pos[depth]++];
+				if (!index[w]) {
+					index[w] = low[w] = ++counter;
+					stack[sp++] = w;
+					on_stack[w] = 1;
+					call[++depth] = w;
+					call_pos[depth] = start[w];
+				} else if (on_stack[w] && index[w] < low[u]) {
+					low[u] = index[w];
+				}
+				continue;
+			}
+			if (low[u] == index[u]) {
+				int k = sp;
+				do { --k; } while (stack[k] != u);
+				int rep = u;
+				for (int i = k; i < sp; ++i) {
+					if (lit_var(stack[i]) < lit_var(rep)) rep = stack[i];
+				}
+				for (int i = k; i < sp; ++i) {
+					on_stack[stack[i]] = 0;
+					repr[stack[i]] = rep;
+				}
+				sp = k;
+			}
+			if (--depth >= 0 && low[u] < low[call[depth]]) low[call[depth]] = low[u];
+		}
+	}
+
+	int substituted = 0;
+	for (int v = 1; v <= nv; ++v) {
+		int pl = mk_lit(v, 0);
+		if (repr[pl] == repr[lit_not(pl)]) {
+			// v and -v imply each other through binary clauses
+			log_add(p, &pl, 1);
+			p->unsat = 1;
+			result = 0;
+			goto done;
+		}
+		if (repr[pl] == pl) continue;
+		// v == r as the two clauses (v | -r) and (-v | r)
+		int r = lit_to_dimacs(repr[pl]);
+		if (elim_push(p->elim, v) != 0 || elim_push(p->elim, -r) != 0 || elim_push(p->elim, 2) != 0 ||
+			elim_push(p->elim, -v) != 0 || elim_push(p->elim, r) != 0 || elim_push(p->elim, 2) != 0) {
+			goto done;
+		}
+		p->eliminated[v] = 1;
+		substituted++;
+	}
+	if (substituted) {
+		// The rewritten clauses are RUP through the binary clauses of the
+		// components, so the old ones are removed only after all are added
+		uint32_t n = p->num_clauses;
+		p->scan.size = 0;
+		for (uint32_t id = 0; id < n && !p->unsat; ++id) {
+			if (is_deleted(p, id)) continue;
+			const ArenaClause *c = pclause(p, id);
+			uint32_t i = 0;
+			while (i < c->size && repr[c->lits[i]] == c->lits[i]) ++i;
+			if (i == c->size) continue;
+			p->tmp_size = 0;
+			for (i = 0; i < c->size; ++i) {
+				if (tmp_push(p, repr[c->lits[i]]) != 0) goto done;
+			}
+			if (idvec_push(&p->scan, id) != 0 || add_clause(p, p->tmp, (uint32_t)p->tmp_size, 1) != 0) goto done;
+		}
+		for (uint32_t k = 0; k < p->scan.size; ++k) delete_clause(p, p->scan.data[k]);
+		for (int v = 1; v <= nv; ++v) {
+			if (repr[mk_lit(v, 0)] != mk_lit(v, 0)) p->occ[v].size = 0;
+		}
+		propagate_units(p);
+	}
+	p->stats.equivalences += substituted;
+	result = substituted;
+
+done:
+	free(start);
+	free(fill);
+	free(index);
+	free(low);
+	free(call_pos);
+	free(call);
+	free(stack);
+	free(repr);
+	free(on_stack);
+	free(edges);
+	return result;
+}
+
+static void free_pre(Pre *p) {
+	arena_free(&p->arena);
+	free(p->refs);
+	free(p->sigs);
+	free(p->queued);
+	if (p->occ) {
+		for (int v = 0; v <= p->num_vars; ++v) free(p->occ[v].data);
+	}
+	free(p->occ);
+	free(p->vals);
+	free(p->eliminated);
+	free(p->stamp);
+	free(p->units);
+	free_watches(p);
+	free(p->trail);
+	free(p->queue.data);
+	free(p->scan.data);
+	free(p->pos.data);
+	free(p->neg.data);
+	free(p->tmp);
+}
+
+static int write_result(Pre *p, OptCNF *out) {
+	if (opt_cnf_init(out, p->num_vars) != 0) return -2;
+	if (p->unsat) return opt_cnf_add_clause(out, NULL, 0) == 0 ? 0 : -2;
+	int d[64];
+	for (int i = 0; i < p->units_size; ++i) {
+		d[0] = lit_to_dimacs(p->units[i]);
+		if (opt_cnf_add_clause(out, d, 1) != 0) return -2;
+	}
+	for (uint32_t id = 0; id < p->num_clauses; ++id) {
+		if (is_deleted(p, id)) continue;
+		const ArenaClause *c = pclause(p, id);
+		int *buf = c->size <= 64 ? d : (int *)malloc(c->size * sizeof(int));
+		if (!buf) return -2;
+		for (uint32_t i = 0; i < c->size; ++i) buf[i] = lit_to_dimacs(c->lits[i]);
+		int r = opt_cnf_add_clause(out, buf, c->size);
+		if (buf != d) free(buf);
+		if (r != 0) return -2;
+	}
+	return 1;
+}
+
+int preprocess_cnf(const OptCNF *in, OptCNF *out, ElimStack *elim, const PreprocessOptions *opts,
+	PreprocessStats *stats) {
+	if (!in || !out || !elim) return -2;
+	if (opts && opts->proof && proof_format(opts->proof) == PROOF_LRAT) return -2;
+	clock_t start = clock();
+	memset(elim, 0, sizeof(*elim));
+	Pre pre;
+	Pre *p = &pre;
+	memset(p, 0, sizeof(*p));
+	if (opts) p->opts = *opts;
+	else preprocess_default_options(&p->opts);
+	p->budget = p->opts.budget;
+	p->elim = elim;
+	int nv = in->num_variables;
+	p->num_vars = nv;
+	p->stats.clauses_before = in->num_clauses;
+	size_t nl = (size_t)(2 * nv + 2);
+	p->occ = (IdVec *)calloc((size_t)nv + 1, sizeof(IdVec));
+	p->vals = (int8_t *)calloc(nl, sizeof(int8_t));
+	p->eliminated = (unsigned char *)calloc((size_t)nv + 1, 1);
+	p->stamp = (uint32_t *)calloc(nl, sizeof(uint32_t));
+	p->units = (int *)malloc(((size_t)nv + 1) * sizeof(int));
+	p->trail = (int *)malloc(((size_t)nv + 1) * sizeof(int));
+	int r = -2;
+	if (!p->occ || !p->vals || !p->eliminated || !p->stamp || !p->units || !p->trail ||
+		arena_init(&p->arena, (size_t)in->arena.size + 1024) != 0) {
+		goto finish;
+	}
+
+	// Original clauses, converted to packed literals
+	for (size_t i = 0; i < in->num_clauses && !p->unsat; ++i) {
+		const ArenaClause *c = arena_clause(&in->arena, in->clauses[i]);
+		p->tmp_size = 0;
+		for (uint32_t j = 0; j < c->size; ++j) {
+			int d = c->lits[j];
+			int v = d > 0 ? d : -d;
+			if (v < 1 || v > nv) goto finish;
+			if (tmp_push(p, lit_from_dimacs(d)) != 0) goto finish;
+		}
+		if (add_clause(p, p->tmp, c->size, 0) != 0) goto finish;
+	}
+	propagate_units(p);
+	subsumption_round(p);
+	if ((p->opts.probe || p->opts.substitute) && !p->unsat) {
+		clock_t probe_start = clock();
+		if (p->opts.probe && probe_round(p) != 0) goto finish;
+		if (p->opts.substitute && !p->unsat && substitute_equivalences(p) < 0) goto finish;
+		subsumption_round(p);
+		p->stats.probe_ms = (double)(clock() - probe_start) * 1000.0 / (double)CLOCKS_PER_SEC;
+	}
+	if (p->opts.eliminate) {
+		// Repeat while eliminations keep enabling new ones
+		for (int round = 0; round < 3 && !p->unsat && p->budget > 0; ++round) {
+			int e = elimination_round(p);
+			if (e < 0) goto finish;
+			if (e == 0) break;
+		}
+	}
+	if (p->unsat < 0) goto finish;
+	if (p->unsat) log_add(p, NULL, 0);
+	r = write_result(p, out);
+	if (r < 0) free_opt_cnf(out);
+
+finish:
+	p->stats.clauses_after = r >= 0 ? out->num_clauses : 0;
+	p->stats.ms = (double)(clock() - start) * 1000.0 / (double)CLOCKS_PER_SEC;
+	if (stats) *stats = p->stats;
+	free_pre(p);
+	if (r < 0) elim_stack_free(elim);
+	return r;
+}
+
+void preprocess_extend_model(const ElimStack *elim, Assignment *model) {
+	if (!model || !model->values) return;
+	for (int v = 1; v <= model->num_variables; ++v) {
+		if (model->values[v] == 0) model->values[v] = 1;
+	}
+	if (!elim) return;
+	// Latest elimination first: a record's clause only mentions variables
+	// that were still present, i.e. eliminated later or never
+	size_t i = elim->size;
+	while (i > 0) {
+		int n = elim->data[--i];
+		i -= (size_t)n;
+		const int *c = elim->data + i;
+		int satisfied = 0;
+		for (int k = 1; k < n && !satisfied; ++k) {
+			int v = c[k] > 0 ? c[k] : -c[k];
+			satisfied = model->values[v] == (c[k] > 0 ? 1 : -1);
+		}
+		if (!satisfied) model->values[c[0] > 0 ? c[0] : -c[0]] = c[0] > 0 ? 1 : -1;
+	}
+}
+
+void elim_stack_free(ElimStack *elim) {
+	if (!elim) return;
+	free(elim->data);
+	memset(elim, 0, sizeof(*elim));
+}
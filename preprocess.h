@@ -0,0 +1,64 @@
+// preprocess.h - SatELite-style simplification between parsing and search
+#ifndef SAT_PREPROCESS_H
+#define SAT_PREPROCESS_H
+
+#include "solver.h"
+#include <stddef.h>
+
+typedef struct PreprocessOptions {
+	int eliminate;          // bounded variable elimination on/off
+	int resolvent_limit;    // a variable is kept if a resolvent would be longer
+	int clause_growth;      // extra clauses an elimination may add (0: never grow)
+	unsigned long budget;   // clause visits for subsumption and elimination
+	int probe;              // failed-literal probing on/off
+	int substitute;         // equivalent-literal substitution on/off
+	long probe_ms;          // time budget for probing in ms (<= 0: no limit)
+	struct ProofWriter *proof; // DRAT log of every clause added or removed, NULL = off
+} PreprocessOptions;
+
+typedef struct PreprocessStats {
+	size_t clauses_before;
+	size_t clauses_after;
+	int fixed_vars;             // assigned by top-level units
+	int eliminated_vars;
+	unsigned long subsumed;     // clauses removed by backward subsumption
+	unsigned long strengthened; // literals removed by self-subsuming resolution
+	unsigned long resolvents;   // clauses added by variable elimination
+	int failed_literals;        // probes that ended in a conflict
+	int necessary;              // units implied by both polarities of a probe
+	int equivalences;           // variables replaced by an equivalent literal
+	unsigned long probes;
+	double probe_ms;
+	double ms;
+} PreprocessStats;
+
+// Clauses removed with eliminated or substituted variables, in DIMACS form:
+// each record is the literals (the removed variable's first) followed by
+// their count
+typedef struct ElimStack {
+	int *data;
+	size_t size;
+	size_t capacity;
+} ElimStack;
+
+// Fill 'opts' with the defaults used by preprocess_cnf
+void preprocess_default_options(PreprocessOptions *opts);
+
+// Unit propagation, failed-literal probing, equivalent-literal substitution
+// (SCCs of the binary implication graph), backward subsumption,
+// self-subsuming strengthening and bounded variable elimination. 'out' receives the
+// simplified formula over the same variables; 'elim' what
+// preprocess_extend_model needs. opts and stats may be NULL.
+// Returns 1 if simplified, 0 if the formula was found UNSAT ('out' is then
+// the empty clause), -2 on error. The simplifications are logged as DRAT
+// only: an LRAT writer in opts->proof is an error.
+int preprocess_cnf(const OptCNF *in, OptCNF *out, ElimStack *elim, const PreprocessOptions *opts,
+	PreprocessStats *stats);
+
+// Turn a model of the simplified formula into one of the original formula by
+// assigning the eliminated variables (and unassigned ones, as true)
+void preprocess_extend_model(const ElimStack *elim, Assignment *model);
+
+void elim_stack_free(ElimStack *elim);
+
+#endif // SAT_PREPROCESS_H
@@ -0,0 +1,211 @@
+#include "proof.h"
+#include "literal.h"
+#include "parallel.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Longest encoding of one item: a signed 64-bit number plus a separator
+#define PROOF_ITEM_BYTES 24
+
+struct ProofWriter {
+	ProofFormat format;
+	FILE *fp;
+	uint64_t next_id;
+	unsigned char *buf;     // being filled by the solver
+	size_t len;
+	unsigned char *spare;   // owned by the writer thread while 'pending'
+	size_t pending;         // bytes of 'spare' to write, 0 when the thread is idle
+	int closing;
+	int error;
+	pthread_t thread;
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+	ProofStats stats;
+};
+
+static void *proof_thread(void *arg) {
+	ProofWriter *w = (ProofWriter *)arg;
+	pthread_mutex_lock(&w->lock);
+	for (;;) {
+		while (!w->pending && !w->closing) pthread_cond_wait(&w->cond, &w->lock);
+		if (!w->pending) break;
+		size_t n = w->pending;
+		pthread_mutex_unlock(&w->lock);
+		int failed = fwrite(w->spare, 1, n, w->fp) != n;
+		pthread_mutex_lock(&w->lock);
+		if (failed) w->error = 1;
+		w->pending = 0;
+		pthread_cond_broadcast(&w->cond);
+	}
+	pthread_mutex_unlock(&w->lock);
+	return NULL;
+}
+
+// Hand the filled buffer to the writer thread and continue in the other one
+static void hand_over(ProofWriter *w) {
+	if (w->len == 0) return;
+	pthread_mutex_lock(&w->lock);
+	if (w->pending) {
+		double t0 = wall_ms();
+		while (w->pending) pthread_cond_wait(&w->cond, &w->lock);
+		w->stats.wait_ms += wall_ms() - t0;
+	}
+	unsigned char *full = w->buf;
+	w->buf = w->spare;
+	w->spare = full;
+	w->pending = w->len;
+	pthread_cond_broadcast(&w->cond);
+	pthread_mutex_unlock(&w->lock);
+	w->stats.bytes += w->len;
+	w->len = 0;
+}
+
+static inline unsigned char *reserve(ProofWriter *w) {
+	if (PROOF_BUFFER_SIZE - w->len < PROOF_ITEM_BYTES) hand_over(w);
+	return w->buf + w->len;
+}
+
+static void put_byte(ProofWriter *w, unsigned char b) {
+	*reserve(w) = b;
+	w->len++;
+}
+
+// Decimal digits of v followed by 'sep'
+static void put_text(ProofWriter *w, int negative, uint64_t v, unsigned char sep) {
+	unsigned char *p = reserve(w);
+	unsigned char tmp[20];
+	int k = 0;
+	do {
+		tmp[k++] = (unsigned char)('0' + v % 10);
+		v /= 10;
+	} while (v);
+	if (negative) *p++ = '-';
+	while (k > 0) *p++ = tmp[--k];
+	*p++ = sep;
+	w->len = (size_t)(p - w->buf);
+}
+
+static void put_varint(ProofWriter *w, uint64_t v) {
+	unsigned char *p = reserve(w);
+	while (v >= 0x80) {
+		*p++ = (unsigned char)(v | 0x80);
+		v >>= 7;
+	}
+	*p++ = (unsigned char)v;
+	w->len = (size_t)(p - w->buf);
+}
+
+static void put_lits(ProofWriter *w, const int *lits, int n) {
+	if (w->format == PROOF_DRAT_BINARY) {
+		// The packed encoding is already 2*var+sign
+		for (int i = 0; i < n; ++i) put_varint(w, (uint64_t)(unsigned)lits[i]);
+		put_byte(w, 0);
+		return;
+	}
+	for (int i = 0; i < n; ++i) put_text(w, lit_neg(lits[i]), (uint64_t)lit_var(lits[i]), ' ');
+	put_byte(w, '0');
+}
+
+ProofWriter *proof_open(const char *path, ProofFormat format, uint64_t num_clauses) {
+	ProofWriter *w = (ProofWriter *)calloc(1, sizeof(ProofWriter));
+	if (!w) return NULL;
+	w->format = format;
+	w->next_id = num_clauses + 1;
+	w->buf = (unsigned char *)malloc(PROOF_BUFFER_SIZE);
+	w->spare = (unsigned char *)malloc(PROOF_BUFFER_SIZE);
+	w->fp = fopen(path, "wb");
+	if (!w->buf || !w->spare || !w->fp) goto fail;
+	// The thread writes whole buffers itself, stdio buffering would only copy
+	setvbuf(w->fp, NULL, _IONBF, 0);
+	if (pthread_mutex_init(&w->lock, NULL) != 0) goto fail;
+	if (pthread_cond_init(&w->cond, NULL) != 0) {
+		pthread_mutex_destroy(&w->lock);
+		goto fail;
+	}
+	if (pthread_create(&w->thread, NULL, proof_thread, w) != 0) {
+		pthread_cond_destroy(&w->cond);
+		pthread_mutex_destroy(&w->lock);
+		goto fail;
+	}
+	return w;
+fail:
+	if (w->fp) fclose(w->fp);
+	free(w->buf);
+	free(w->spare);
+	free(w);
+	return NULL;
+}
+
+int proof_close(ProofWriter *w, ProofStats *stats) {
+	if (!w) return -1;
+	hand_over(w);
+	pthread_mutex_lock(&w->lock);
+	w->closing = 1;
+	pthread_cond_broadcast(&w->cond);
+	pthread_mutex_unlock(&w->lock);
+	pthread_join(w->thread, NULL);
+	pthread_cond_destroy(&w->cond);
+	pthread_mutex_destroy(&w->lock);
+	int r = w->error ? -1 : 0;
+	if (fclose(w->fp) != 0) r = -1;
+	if (stats) *stats = w->stats;
+	free(w->buf);
+	free(w->spare);
+	free(w);
+	return r;
+}
+
+ProofFormat proof_format(const ProofWriter *w) {
+	return w->format;
+}
+
+uint64_t proof_add(ProofWriter *w, const int *lits, int n, const uint64_t *hints, int num_hints) {
+	uint64_t id = w->next_id++;
+	w->stats.additions++;
+	switch (w->format) {
+	case PROOF_DRAT:
+		put_lits(w, lits, n);
+		put_byte(w, '\n');
+		break;
+	case PROOF_DRAT_BINARY:
+		put_byte(w, 'a');
+		put_lits(w, lits, n);
+		break;
+	case PROOF_LRAT:
+		put_text(w, 0, id, ' ');
+		put_lits(w, lits, n);
+		put_byte(w, ' ');
+		for (int i = 0; i < num_hints; ++i) put_text(w, 0, hints[i], ' ');
+		put_byte(w, '0');
+		put_byte(w, '\n');
+		break;
+	}
+	return id;
+}
+
+void proof_delete(ProofWriter *w, const int *lits, int n, uint64_t id) {
+	w->stats.deletions++;
+	switch (w->format) {
+	case PROOF_DRAT:
+		put_byte(w, 'd');
+		put_byte(w, ' ');
+		put_lits(w, lits, n);
+		put_byte(w, '\n');
+		break;
+	case PROOF_DRAT_BINARY:
+		put_byte(w, 'd');
+		put_lits(w, lits, n);
+		break;
+	case PROOF_LRAT:
+		// The leading id only has to be one already used
+		put_text(w, 0, w->next_id - 1, ' ');
+		put_byte(w, 'd');
+		put_byte(w, ' ');
+		put_text(w, 0, id, ' ');
+		put_byte(w, '0');
+		put_byte(w, '\n');
+		break;
+	}
+}
@@ -0,0 +1,44 @@
+// proof.h - DRAT/LRAT certificates of UNSAT answers, written by a background thread
+#ifndef SAT_PROOF_H
+#define SAT_PROOF_H
+
+#include <stdint.h>
+
+// Bytes per buffer; the solver fills one while the other is being written
+#define PROOF_BUFFER_SIZE (1u << 22)
+
+typedef enum {
+	PROOF_DRAT,         // text: "l1 l2 0", deletions "d l1 l2 0"
+	PROOF_DRAT_BINARY,  // 'a'/'d' then 2*var+sign as 7-bit varints, ending in 0
+	PROOF_LRAT          // text: "id l1 l2 0 hint1 hint2 0", deletions "id d id1 id2 0"
+} ProofFormat;
+
+typedef struct ProofStats {
+	unsigned long additions;
+	unsigned long deletions;
+	unsigned long long bytes;
+	double wait_ms;     // time spent waiting for the writer thread
+} ProofStats;
+
+typedef struct ProofWriter ProofWriter;
+
+// Start a proof for a formula of num_clauses clauses; in LRAT they keep
+// their input positions 1..num_clauses as ids. Returns NULL if the file
+// cannot be created or the writer thread cannot start.
+ProofWriter *proof_open(const char *path, ProofFormat format, uint64_t num_clauses);
+
+// Write what is left, stop the thread and close the file. Returns 0, or -1
+// if any write failed; stats may be NULL.
+int proof_close(ProofWriter *w, ProofStats *stats);
+
+ProofFormat proof_format(const ProofWriter *w);
+
+// Lemma of n packed literals (literal.h). 'hints' are the LRAT antecedent
+// ids in propagation order, ignored by DRAT. Returns the clause's id, which
+// is counted in every format.
+uint64_t proof_add(ProofWriter *w, const int *lits, int n, const uint64_t *hints, int num_hints);
+
+// Clause no longer used: DRAT identifies it by its literals, LRAT by 'id'
+void proof_delete(ProofWriter *w, const int *lits, int n, uint64_t id);
+
+#endif // SAT_PROOF_H
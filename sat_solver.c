@@ -1,13 +1,27 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <time.h>
 #include "parser.h"
 #include "solver.h"
 #include "parser_opt.h"
+#include "cnf_stream.h"
+#include "parallel.h"
+#include "cnf_cache.h"
+#include "out_buffer.h"
+#include "preprocess.h"
+#include "portfolio.h"
+#include "cube.h"
+#include "proof.h"
+#include "check.h"
 
 static void usage(const char *prog) {
-	fprintf(stderr, "Usage: %s <input.cnf> [--print] [--model] [--timeout MS] [--check]\n", prog);
+	fprintf(stderr, "Usage: %s <input.cnf[.gz|.xz|.bz2] | -> [--print] [--model] [--timeout MS] [--check] [--dpll] [--decide vsids|static]\n"
+		"       [--phase saved|false|true|random|target|best] [--seed N]\n"
+		"       [--restart glucose|luby|none] [--parse-threads N] [--cache]\n"
+		"       [--vwrap COLS] [--preprocess] [--probe-ms MS] [--no-probe] [--no-gauss]\n"
+		"       [--threads N] [--no-share] [--share-lbd N] [--share-size N]\n"
+		"       [--cube] [--cubes N] [--lookahead-ms MS]\n"
+		"       [--proof FILE] [--proof-format drat|binary|lrat]\n", prog);
 }
 
 int main(int argc, char **argv) {
@@ -16,116 +30,406 @@ int main(int argc, char **argv) {
 	int do_print = 0;
 	int do_model = 0;
 	int do_check = 0;
+	int use_dpll = 0;
 	long timeout_ms = 0;
+	int parse_threads = 1;
+	int use_cache = 0;
+	int vwrap = 0;
+	int do_preprocess = 0;
+	int threads = 1;
+	int share = 1;
+	ExchangeOptions xopts;
+	exchange_default_options(&xopts);
+	int use_cube = 0;
+	CubeOptions copts;
+	cube_default_options(&copts);
+	const char *proof_path = NULL;
+	ProofFormat proof_fmt = PROOF_DRAT;
+	PreprocessOptions popts;
+	preprocess_default_options(&popts);
+	SolverOptions opts;
+	solver_default_options(&opts);
 	for (int i = 2; i < argc; ++i) {
 		if (strcmp(argv[i], "--print") == 0) do_print = 1;
 		else if (strcmp(argv[i], "--model") == 0) do_model = 1;
 		else if (strcmp(argv[i], "--check") == 0) do_check = 1;
+		else if (strcmp(argv[i], "--dpll") == 0) use_dpll = 1;
 		else if (strcmp(argv[i], "--timeout") == 0 && i + 1 < argc) { timeout_ms = atol(argv[++i]); }
+		else if (strcmp(argv[i], "--decide") == 0 && i + 1 < argc) {
+			const char *h = argv[++i];
+			if (strcmp(h, "vsids") == 0) opts.decision = DECIDE_VSIDS;
+			else if (strcmp(h, "static") == 0) opts.decision = DECIDE_STATIC;
+			else { usage(argv[0]); return 1; }
+		}
+		else if (strcmp(argv[i], "--phase") == 0 && i + 1 < argc) {
+			const char *ph = argv[++i];
+			if (strcmp(ph, "saved") == 0) opts.phase = PHASE_SAVED;
+			else if (strcmp(ph, "false") == 0) opts.phase = PHASE_FALSE;
+			else if (strcmp(ph, "true") == 0) opts.phase = PHASE_TRUE;
+			else if (strcmp(ph, "random") == 0) opts.phase = PHASE_RANDOM;
+			else if (strcmp(ph, "target") == 0) opts.phase = PHASE_TARGET;
+			else if (strcmp(ph, "best") == 0) opts.phase = PHASE_BEST;
+			else { usage(argv[0]); return 1; }
+		}
+		else if (strcmp(argv[i], "--restart") == 0 && i + 1 < argc) {
+			const char *rs = argv[++i];
+			if (strcmp(rs, "glucose") == 0) opts.restart = RESTART_GLUCOSE;
+			else if (strcmp(rs, "luby") == 0) opts.restart = RESTART_LUBY;
+			else if (strcmp(rs, "none") == 0) opts.restart = RESTART_NONE;
+			else { usage(argv[0]); return 1; }
+		}
+		else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) { opts.seed = strtoull(argv[++i], NULL, 10); }
+		else if (strcmp(argv[i], "--parse-threads") == 0 && i + 1 < argc) { parse_threads = atoi(argv[++i]); }
+		else if (strcmp(argv[i], "--cache") == 0) use_cache = 1;
+		else if (strcmp(argv[i], "--vwrap") == 0 && i + 1 < argc) { vwrap = atoi(argv[++i]); }
+		else if (strcmp(argv[i], "--preprocess") == 0) do_preprocess = 1;
+		else if (strcmp(argv[i], "--probe-ms") == 0 && i + 1 < argc) { popts.probe_ms = atol(argv[++i]); }
+		else if (strcmp(argv[i], "--no-probe") == 0) { popts.probe = 0; popts.substitute = 0; }
+		else if (strcmp(argv[i], "--no-gauss") == 0) opts.gauss = 0;
+		else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+			threads = atoi(argv[++i]);
+			if (threads < 0) { usage(argv[0]); return 1; }
+		}
+		else if (strcmp(argv[i], "--no-share") == 0) share = 0;
+		else if (strcmp(argv[i], "--share-lbd") == 0 && i + 1 < argc) xopts.max_lbd = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--share-size") == 0 && i + 1 < argc) xopts.max_size = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--cube") == 0) use_cube = 1;
+		else if (strcmp(argv[i], "--cubes") == 0 && i + 1 < argc) { use_cube = 1; copts.max_cubes = atoi(argv[++i]); }
+		else if (strcmp(argv[i], "--lookahead-ms") == 0 && i + 1 < argc) copts.lookahead_ms = atol(argv[++i]);
+		else if (strcmp(argv[i], "--proof") == 0 && i + 1 < argc) proof_path = argv[++i];
+		else if (strcmp(argv[i], "--proof-format") == 0 && i + 1 < argc) {
+			const char *pf = argv[++i];
+			if (strcmp(pf, "drat") == 0) proof_fmt = PROOF_DRAT;
+			else if (strcmp(pf, "binary") == 0) proof_fmt = PROOF_DRAT_BINARY;
+			else if (strcmp(pf, "lrat") == 0) proof_fmt = PROOF_LRAT;
+			else { usage(argv[0]); return 1; }
+		}
 		else { usage(argv[0]); return 1; }
 	}
-
-	CNF cnf;
-	clock_t p0 = clock();
-	if (parse_cnf_file(path, &cnf) != 0) {
-		fprintf(stderr, "Failed to parse CNF file: %s\n", path);
+	// Each lemma must follow from the clauses of one search
+	if (proof_path && (use_dpll || use_cube || threads != 1)) {
+		fprintf(stderr, "--proof needs the single-threaded CDCL search\n");
 		return 1;
 	}
-	clock_t p1 = clock();
-	double t_parse_ms = (double)(p1 - p0) * 1000.0 / (double)CLOCKS_PER_SEC;
-	if (do_print) {
-		print_cnf(&cnf, stdout);
+	if (proof_path && proof_fmt == PROOF_LRAT && do_preprocess) {
+		fprintf(stderr, "LRAT proofs cannot be combined with --preprocess, use drat or binary\n");
+		return 1;
 	}
 
-	// Optimized parser timing: parse OptCNF and convert to CNF
+	// Binary cache of the parsed formula next to the input, rebuilt when stale
 	OptCNF ocnf;
-	clock_t q0 = clock();
-	int opt_ok = parse_cnf_file_opt(path, &ocnf);
-	CNF cnf_opt;
-	int conv_ok = 0;
-	if (opt_ok == 0) {
-		conv_ok = (opt_cnf_to_cnf(&ocnf, &cnf_opt) == 0);
-		free_opt_cnf(&ocnf);
+	char cache_file[4096];
+	int cached = 0, cache_written = 0;
+	double t_cache_ms = 0.0;
+	if (use_cache && strcmp(path, CNF_STDIN_PATH) == 0) {
+		fprintf(stderr, "--cache needs an input file\n");
+		use_cache = 0;
+	}
+	if (use_cache) {
+		cnf_cache_path(path, cache_file, sizeof(cache_file));
+		double c0 = wall_ms();
+		int cr = cnf_cache_load(cache_file, path, &ocnf);
+		t_cache_ms = wall_ms() - c0;
+		if (cr < 0) fprintf(stderr, "Ignoring invalid cache: %s\n", cache_file);
+		cached = (cr == 0);
+	}
+
+	// stdin and compressed files can be read only once and only by the
+	// streaming parser, so the comparison parsers are skipped for them
+	int streamed = !cached && cnf_stream_needed(path);
+	CNF cnf;
+	memset(&cnf, 0, sizeof(cnf));
+	double t_parse_ms = 0.0, t_parse_opt_ms = 0.0;
+	int pool_ok = 0;
+	if (!streamed && !cached) {
+		// All parsers are timed by the wall clock: clock() would sum the CPU
+		// time of the --parse-threads workers and skew mmap_optimize
+		double p0 = wall_ms();
+		if (parse_cnf_file(path, &cnf) != 0) {
+			fprintf(stderr, "Failed to parse CNF file: %s\n", path);
+			return 1;
+		}
+		t_parse_ms = wall_ms() - p0;
+		if (do_print) {
+			print_cnf(&cnf, stdout);
+		}
+
+		// Pooled fgetc parser, timed for comparison only
+		double q0 = wall_ms();
+		pool_ok = (parse_cnf_file_opt(path, &ocnf) == 0);
+		t_parse_opt_ms = wall_ms() - q0;
+		if (pool_ok) free_opt_cnf(&ocnf);
+	} else if (do_print) {
+		fprintf(stderr, "--print is not available for stdin, compressed or cached input\n");
+	}
+
+	// Memory-mapped parser (chunked over several threads with --parse-threads):
+	// its clause arena is handed to the solver as is
+	int opt_ok = cached;
+	double t_parse_mmap_ms = 0.0;
+	if (!cached) {
+		double r0 = wall_ms();
+		opt_ok = (parse_threads == 1 ? parse_cnf_file_mmap(path, &ocnf)
+			: parse_cnf_file_parallel(path, &ocnf, parse_threads)) == 0;
+		t_parse_mmap_ms = wall_ms() - r0;
+		if (!opt_ok && streamed) {
+			fprintf(stderr, "Failed to parse CNF file: %s\n", path);
+			return 1;
+		}
+		if (opt_ok && use_cache) {
+			cache_written = (cnf_cache_write(cache_file, path, &ocnf) == 0);
+			if (!cache_written) fprintf(stderr, "Failed to write cache: %s\n", cache_file);
+		}
+	}
+
+	// Clause ids of an LRAT proof start after the input clauses
+	ProofWriter *proof = NULL;
+	ProofStats proof_stats;
+	memset(&proof_stats, 0, sizeof(proof_stats));
+	if (proof_path) {
+		proof = proof_open(proof_path, proof_fmt, opt_ok ? ocnf.num_clauses : cnf.num_clauses);
+		if (!proof) {
+			fprintf(stderr, "Failed to create proof file: %s\n", proof_path);
+			free_cnf(&cnf);
+			if (opt_ok) free_opt_cnf(&ocnf);
+			return 1;
+		}
+		popts.proof = proof;
+		opts.proof = proof;
 	}
-	clock_t q1 = clock();
-	double t_parse_opt_ms = (double)(q1 - q0) * 1000.0 / (double)CLOCKS_PER_SEC;
+
+	// Simplify before the search; the original formula is kept for --check
+	OptCNF pcnf;
+	ElimStack elim;
+	PreprocessStats pstats;
+	int pre_res = 0;
+	if (do_preprocess && !opt_ok) fprintf(stderr, "--preprocess needs the optimized parser, skipped\n");
+	if (do_preprocess && opt_ok) {
+		pre_res = preprocess_cnf(&ocnf, &pcnf, &elim, &popts, &pstats);
+		if (pre_res < 0 && proof) {
+			// The proof may already delete clauses of the original formula
+			fprintf(stderr, "Preprocessing failed while writing the proof\n");
+			proof_close(proof, NULL);
+			free_cnf(&cnf);
+			free_opt_cnf(&ocnf);
+			return 1;
+		}
+		if (pre_res < 0) fprintf(stderr, "Preprocessing failed, solving the original formula\n");
+	}
+	int preprocessed = do_preprocess && opt_ok && pre_res >= 0;
 
 	Assignment model;
+	SolverStats stats;
+	memset(&stats, 0, sizeof(stats));
 	double ms = 0.0;
-	int res = dpll_solve(&cnf, &model, timeout_ms, &ms);
+	int res;
+	// Portfolio mode: per-thread results, the winner's counters go to 'stats'
+	PortfolioThreadStats tstats[PORTFOLIO_MAX_THREADS];
+	int num_threads = 0;
+	int winner = -1;
+	CubeStats cstats;
+	memset(&cstats, 0, sizeof(cstats));
+	if ((threads != 1 || use_cube) && (use_dpll || !opt_ok)) {
+		fprintf(stderr, "--threads and --cube need the CDCL search and the optimized parser, ignored\n");
+		use_cube = 0;
+	}
+	if (opt_ok) {
+		const OptCNF *scnf = preprocessed ? &pcnf : &ocnf;
+		if (use_dpll) {
+			res = dpll_solve_opt(scnf, &model, timeout_ms, &ms);
+		} else if (use_cube) {
+			copts.threads = threads;
+			res = cube_solve(scnf, &model, &opts, &copts, share ? &xopts : NULL, timeout_ms, &cstats, &ms);
+			for (int t = 0; t < cstats.threads; ++t) {
+				// Counters summed over the workers
+				const SolverStats *ws = &cstats.workers[t].stats;
+				stats.decisions += ws->decisions;
+				stats.conflicts += ws->conflicts;
+				stats.propagations += ws->propagations;
+				stats.restarts += ws->restarts;
+				stats.reductions += ws->reductions;
+				stats.deleted_clauses += ws->deleted_clauses;
+				stats.learned_clauses += ws->learned_clauses;
+				stats.garbage_collections += ws->garbage_collections;
+			}
+		} else if (threads != 1) {
+			res = portfolio_solve(scnf, &model, &opts, threads, share ? &xopts : NULL, timeout_ms, tstats,
+				&num_threads, &winner, &ms);
+			if (num_threads > 0) stats = tstats[winner >= 0 ? winner : 0].stats;
+		} else {
+			res = cdcl_solve_opt(scnf, &model, &opts, &stats, timeout_ms, &ms);
+		}
+		if (preprocessed) {
+			if (res == 1) preprocess_extend_model(&elim, &model);
+			free_opt_cnf(&pcnf);
+			elim_stack_free(&elim);
+		}
+	} else {
+		if (proof) fprintf(stderr, "--proof needs the optimized parser, no lemmas logged\n");
+		res = use_dpll ? dpll_solve(&cnf, &model, timeout_ms, &ms)
+		               : cdcl_solve(&cnf, &model, timeout_ms, &ms);
+	}
+	if (proof && proof_close(proof, &proof_stats) != 0) {
+		fprintf(stderr, "Failed to write proof file: %s\n", proof_path);
+	}
 
-	// Prepare .res file path
+	// Prepare .res file path: x.cnf.gz -> x.res, stdin -> stdin.res
 	char outpath[4096];
-	const char *dot = strrchr(path, '.');
-	if (!dot) dot = path + strlen(path);
-	size_t base_len = (size_t)(dot - path);
+	const char *base = strcmp(path, CNF_STDIN_PATH) == 0 ? "stdin" : path;
+	size_t base_len = strlen(base);
+	static const char *const packed_ext[] = {".gz", ".xz", ".bz2"};
+	for (size_t k = 0; k < sizeof(packed_ext) / sizeof(packed_ext[0]); ++k) {
+		size_t n = strlen(packed_ext[k]);
+		if (base_len > n && strcmp(base + base_len - n, packed_ext[k]) == 0) { base_len -= n; break; }
+	}
+	for (size_t k = base_len; k > 0; --k) {
+		if (base[k - 1] == '.') { base_len = k - 1; break; }
+	}
 	if (base_len >= sizeof(outpath) - 5) base_len = sizeof(outpath) - 5;
-	memcpy(outpath, path, base_len);
+	memcpy(outpath, base, base_len);
 	memcpy(outpath + base_len, ".res", 5);
 
-	FILE *rf = fopen(outpath, "w");
-	if (!rf) {
-		fprintf(stderr, "Failed to open result file: %s\n", outpath);
+	int s_val = (res == 1 || res == 0) ? res : -1;
+	if (out_write_result(outpath, s_val, res == 1 ? model.values : NULL, res == 1 ? model.num_variables : 0, ms, vwrap) != 0) {
+		fprintf(stderr, "Failed to write result file: %s\n", outpath);
 		free_cnf(&cnf);
+		if (opt_ok) free_opt_cnf(&ocnf);
 		if (res == 1) free_assignment(&model);
 		return 3;
 	}
 
-	int s_val = 0;
-	if (res == 1) s_val = 1;
-	else if (res == 0) s_val = 0;
-	else if (res == -1) s_val = -1;
-	else s_val = -1;
-	fprintf(rf, "s %d\n", s_val);
-	if (res == 1) {
-		fprintf(rf, "v ");
-		for (int v = 1; v <= model.num_variables; ++v) {
-			int lit = model.values[v] >= 0 ? v : -v;
-			if (model.values[v] == 0) lit = v; // default unassigned to positive
-			fprintf(rf, "%d ", lit);
-		}
-		fprintf(rf, "\n");
-	}
-	fprintf(rf, "t %.0f\n", ms);
-	fclose(rf);
-
 	// Optional console output
 	if (res == 1) {
 		printf("SAT (%.0f ms) -> %s\n", ms, outpath);
 		if (do_model) {
-			for (int v = 1; v <= model.num_variables; ++v) {
-				int lit = model.values[v] >= 0 ? v : -v;
-				if (model.values[v] == 0) lit = v;
-				printf("%d ", lit);
-			}
-			printf("0\n");
+			// --vwrap switches to competition-style "v ... 0" lines
+			OutBuffer ob;
+			out_init(&ob, stdout);
+			out_model(&ob, model.values, model.num_variables, vwrap > 0 ? "v " : "", vwrap, 1);
+			out_flush(&ob);
 		}
 		if (do_check) {
-			int ok = verify_model_satisfies(&cnf, &model);
-			printf("check: %s\n", ok == 1 ? "OK" : (ok == 0 ? "FAIL" : "ERROR"));
+			// Against the formula as parsed, not the preprocessed one
+			CheckStats cks;
+			memset(&cks, 0, sizeof(cks));
+			int ok = opt_ok ? check_model(&ocnf, &model, 0, &cks) : verify_model_satisfies(&cnf, &model);
+			if (ok == 0 && opt_ok) printf("check: FAIL clause %zu\n", cks.failed_clause + 1);
+			else printf("check: %s\n", ok == 1 ? "OK" : (ok == 0 ? "FAIL" : "ERROR"));
+			if (opt_ok) printf("check_ms=%.1f check_threads=%d\n", cks.ms, cks.threads);
 		}
 		free_assignment(&model);
 	} else if (res == 0) {
 		printf("UNSAT (%.0f ms) -> %s\n", ms, outpath);
+		if (do_check && (!proof || !opt_ok)) {
+			printf("check: SKIPPED (UNSAT answers are checked through --proof)\n");
+		} else if (do_check) {
+			CheckStats cks;
+			memset(&cks, 0, sizeof(cks));
+			int ok = check_proof(&ocnf, proof_path, proof_fmt, &cks);
+			if (ok == 0 && cks.failed_lemma) printf("check: FAIL lemma %lu\n", cks.failed_lemma);
+			else if (ok == 0) printf("check: FAIL no conflict\n");
+			else printf("check: %s\n", ok == 1 ? "OK" : "ERROR");
+			printf("check_ms=%.0f lemmas=%lu core_lemmas=%lu core_clauses=%lu deletions=%lu ignored_deletions=%lu\n",
+				cks.ms, cks.lemmas, cks.core_lemmas, cks.core_clauses, cks.deletions, cks.ignored_deletions);
+		}
 	} else if (res == -1) {
 		printf("TIMEOUT (%.0f ms) -> %s\n", ms, outpath);
 	} else {
 		printf("ERROR -> %s\n", outpath);
 	}
 
-	// Print parser timing comparison and optimization rate
-	if (conv_ok) {
-		printf("parse_ms=%.0f parse_opt_ms=%.0f", t_parse_ms, t_parse_opt_ms);
-		if (t_parse_ms > 0.0) {
-			double rate = (t_parse_ms - t_parse_opt_ms) / t_parse_ms * 100.0;
-			printf(" optimize=%.2f%%\n", rate);
-		} else {
+	if (!use_dpll) {
+		printf("decisions=%lu conflicts=%lu propagations=%lu restarts=%lu\n",
+			stats.decisions, stats.conflicts, stats.propagations, stats.restarts);
+		printf("reductions=%lu deleted=%lu learned=%zu gc=%lu\n",
+			stats.reductions, stats.deleted_clauses, stats.learned_clauses, stats.garbage_collections);
+		if (stats.xor_constraints) {
+			printf("xors=%d gauss_propagations=%lu gauss_conflicts=%lu\n",
+				stats.xor_constraints, stats.gauss_propagations, stats.gauss_conflicts);
+		}
+	}
+	for (int t = 0; t < num_threads; ++t) {
+		static const char *const outcome[] = {"error", "timeout", "unsat", "sat"};
+		const PortfolioThreadStats *ts = &tstats[t];
+		char desc[64];
+		int o = ts->result >= -2 && ts->result <= 1 ? ts->result + 2 : 0;
+		printf("thread %d %s: %s%s ms=%.0f decisions=%lu conflicts=%lu restarts=%lu learned=%zu", t,
+			portfolio_describe(&ts->opts, desc, sizeof(desc)), t == winner ? "winner " : "",
+			t == winner || winner < 0 ? outcome[o] : "cancelled", ts->ms, ts->stats.decisions,
+			ts->stats.conflicts, ts->stats.restarts, ts->stats.learned_clauses);
+		if (share) {
+			printf(" exported=%lu imported=%lu discarded=%lu", ts->stats.exported, ts->stats.imported,
+				ts->stats.share_discarded);
+		}
+		printf("\n");
+	}
+	if (use_cube) {
+		double lo = 0.0, hi = 0.0, sum = 0.0;
+		int done = 0;
+		for (int c = 0; c < cstats.cubes && cstats.cube_ms; ++c) {
+			double t = cstats.cube_ms[c];
+			if (t < 0.0) continue;
+			if (done == 0 || t < lo) lo = t;
+			if (t > hi) hi = t;
+			sum += t;
+			done++;
+		}
+		printf("cubes=%d refuted=%d solved=%d lookahead_ms=%.0f conquer_ms=%.0f imbalance=%.2f",
+			cstats.cubes, cstats.refuted, cstats.solved, cstats.lookahead_ms, cstats.conquer_ms, cstats.imbalance);
+		if (done) printf(" cube_ms=%.1f/%.1f/%.1f", lo, sum / done, hi);
+		if (cstats.sat_cube >= 0) printf(" sat_cube=%d", cstats.sat_cube);
+		printf("\n");
+		for (int t = 0; t < cstats.threads; ++t) {
+			const CubeWorkerStats *w = &cstats.workers[t];
+			printf("worker %d: cubes=%d steals=%lu busy_ms=%.0f conflicts=%lu", t, w->cubes, w->steals, w->busy_ms,
+				w->stats.conflicts);
+			if (share && cstats.threads > 1) {
+				printf(" exported=%lu imported=%lu discarded=%lu", w->stats.exported, w->stats.imported,
+					w->stats.share_discarded);
+			}
 			printf("\n");
 		}
-		free_cnf(&cnf_opt);
-	} else {
-		printf("parse_ms=%.0f\n", t_parse_ms);
+		cube_stats_free(&cstats);
+	}
+	if (proof) {
+		static const char *const formats[] = {"drat", "binary", "lrat"};
+		printf("proof=%s additions=%lu deletions=%lu bytes=%llu wait_ms=%.0f\n", formats[proof_fmt],
+			proof_stats.additions, proof_stats.deletions, proof_stats.bytes, proof_stats.wait_ms);
+	}
+	if (preprocessed) {
+		printf("preprocess_ms=%.0f clauses=%zu->%zu fixed=%d eliminated=%d subsumed=%lu strengthened=%lu resolvents=%lu\n",
+			pstats.ms, pstats.clauses_before, pstats.clauses_after, pstats.fixed_vars, pstats.eliminated_vars,
+			pstats.subsumed, pstats.strengthened, pstats.resolvents);
+		printf("probe_ms=%.0f probes=%lu failed=%d necessary=%d equivalent=%d\n",
+			pstats.probe_ms, pstats.probes, pstats.failed_literals, pstats.necessary, pstats.equivalences);
+	}
+
+	// Print parser timing comparison and optimization rates
+	if (cached) {
+		printf("parse_cache_ms=%.2f\n", t_cache_ms);
+		free_opt_cnf(&ocnf);
+		return 0;
+	}
+	if (streamed) {
+		// Only the streaming parser ran; its time includes decompression
+		printf("parse_stream_ms=%.0f scan=%s%s\n", t_parse_mmap_ms, parse_kernel_name(parse_kernel_detect()),
+			cache_written ? " cache=written" : "");
+		free_opt_cnf(&ocnf);
+		return 0;
+	}
+	printf("parse_ms=%.0f", t_parse_ms);
+	if (pool_ok) printf(" parse_opt_ms=%.0f", t_parse_opt_ms);
+	if (opt_ok) {
+		printf(" parse_mmap_ms=%.0f scan=%s", t_parse_mmap_ms, parse_kernel_name(parse_kernel_detect()));
+		if (parse_threads != 1) printf(" parse_threads=%d", parse_threads);
+		if (cache_written) printf(" cache=written");
+	}
+	if (t_parse_ms > 0.0) {
+		if (pool_ok) printf(" optimize=%.2f%%", (t_parse_ms - t_parse_opt_ms) / t_parse_ms * 100.0);
+		if (opt_ok) printf(" mmap_optimize=%.2f%%", (t_parse_ms - t_parse_mmap_ms) / t_parse_ms * 100.0);
 	}
+	printf("\n");
+	if (opt_ok) free_opt_cnf(&ocnf);
 	free_cnf(&cnf);
 	return 0;
 }
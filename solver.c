@@ -1,10 +1,15 @@
 #include "solver.h"
+#include "literal.h"
+#include "gauss.h"
+#include "exchange.h"
+#include "proof.h"
+#include "parallel.h"
+#include <limits.h>
 #include <stdlib.h>
 #include <string.h>
-#include <time.h>
 
 int init_assignment(Assignment *a, int num_variables) {
-	if (!a || num_variables <= 0) return -1;
+	if (!a || num_variables < 0) return -1;
 	a->values = (int *)malloc((size_t)(num_variables + 1) * sizeof(int));
 	if (!a->values) return -1;
 	a->num_variables = num_variables;
@@ -19,135 +24,1843 @@ void free_assignment(Assignment *a) {
 	a->num_variables = 0;
 }
 
-static inline int lit_var(int lit) { return lit > 0 ? lit : -lit; }
-static inline int lit_sign(int lit) { return lit > 0 ? 1 : -1; }
+// Polarity of a packed literal as +1/-1, the form kept in phase tables
+static inline signed char lit_phase(int lit) { return lit_neg(lit) ? -1 : 1; }
 
-// Evaluate a literal under assignment: 1 true, -1 false, 0 unassigned
-static int eval_lit(const Assignment *as, int lit) {
+// Learned clause tiers (stored in ArenaClause.flags above the arena bits):
+// core clauses are kept forever, tier2 clauses while they keep being used,
+// local clauses compete on activity at every reduction
+enum {
+	TIER_LOCAL = 0,
+	TIER_TIER2 = 1,
+	TIER_CORE = 2,
+	CLAUSE_TIER_SHIFT = 4,
+	CLAUSE_TIER_MASK = 3 << CLAUSE_TIER_SHIFT,
+	CLAUSE_USED = 64      // took part in conflict analysis since the last reduction
+};
+
+// Compact the arena once deleted clauses hold this share of it
+#define GC_WASTE_FRACTION 0.20
+
+// Clauses watching a literal; visited when that literal becomes false
+typedef struct WatchList {
+	ClauseRef *refs;
+	int size;
+	int capacity;
+} WatchList;
+
+// Binary clauses watching a literal: the other literal is stored inline so
+// propagation never touches clause memory; the reference is only needed as
+// the reason of the implied literal
+typedef struct BinWatch {
+	int other;
+	ClauseRef ref;
+} BinWatch;
+
+typedef struct BinList {
+	BinWatch *data;
+	int size;
+	int capacity;
+} BinList;
+
+typedef struct RefVec {
+	ClauseRef *data;
+	size_t size;
+	size_t capacity;
+} RefVec;
+
+// Indexed binary max-heap of variables keyed by activity
+typedef struct VarHeap {
+	int *heap;          // heap[0..size) holds variables
+	int *pos;           // pos[v] = index of v in heap, -1 if absent
+	int size;
+} VarHeap;
+
+typedef struct SolverCtx {
+	int num_vars;
+	Assignment *assignment; // receives the model on SAT
+	int8_t *vals;           // LIT_* value of every packed literal, size 2*(num_vars+1)
+	SolverOptions opts;
+	SolverStats stats;
+	double start_ms;
+	long timeout_ms; // <= 0 means no timeout
+
+	// Clause arena; the first two literals of each clause are watched
+	ClauseArena arena;
+	RefVec originals;
+	RefVec learnts;
+	float cla_inc;
+	unsigned long next_reduce;   // conflict count that triggers the next reduction
+	unsigned long reduce_interval;
+
+	WatchList *watches; // clauses of 3+ literals, indexed by packed literal, size 2*(num_vars+1)
+	BinList *bins;      // binary clauses, indexed like watches
+
+	// Assignment trail (packed literals) in order; [qhead, trail_size) still to
+	// propagate over long clauses, [bin_qhead, trail_size) over binary clauses
+	int *trail;
+	int trail_size;
+	int qhead;
+	int bin_qhead;
+
+	// Decision levels: trail_lim[d] is the trail position where level d+1 starts,
+	// flipped[d] is set once the decision of that level has been negated
+	int *trail_lim;
+	unsigned char *flipped;
+	int num_levels;
+
+	// Per-variable implication graph: decision level and reason clause
+	int *level;
+	ClauseRef *reason;  // CLAUSE_REF_UNDEF for decisions and level-0 units
+	ClauseRef conflict; // clause falsified by the last failed propagation
+
+	// Conflict analysis scratch space
+	unsigned char *seen;
+	int *learnt;
+	int *analyze_stack;
+	int *analyze_clear;
+	int num_clear;
+
+	// Decision order: EVSIDS activities in a heap, or a static scan cursor
+	double *activity;
+	double var_inc;
+	VarHeap order;
+	int static_next;
+
+	// Polarity: last assigned value per variable, plus the assignments of the
+	// longest conflict-free trail (target) and the longest one ever seen (best)
+	signed char *saved_phase;
+	signed char *target_phase;
+	signed char *best_phase;
+	int target_size;
+	int best_size;
+	unsigned long long rng;
+
+	// Restart scheduling
+	unsigned *level_stamp;      // per-level marks for LBD computation
+	unsigned stamp;
+	double lbd_fast;            // short-horizon EMA of learned clause LBD
+	double lbd_slow;            // long-horizon EMA of learned clause LBD
+	unsigned long lbd_samples;
+	unsigned long conflicts_since_restart;
+	unsigned long restart_limit; // Luby: conflicts allowed in the current run
+
+	// XOR constraints found among the originals (num_rows 0 when unused).
+	// Reasons of the literals they imply live in a separate arena that is cut
+	// back with the trail; their references carry GAUSS_REASON_TAG.
+	GaussMatrix gauss;
+	ClauseArena gauss_reasons;
+	uint32_t *gauss_lim;    // gauss_reasons.size when each decision level started
+
+	// Assumptions of an incremental call (packed literals): level d+1 belongs
+	// to assumptions[d], empty if it already held. When the call ends UNSAT,
+	// 'failed' holds the assumptions the final conflict depends on.
+	int *assumptions;
+	int num_assumptions;
+	int assumptions_cap;
+	int *failed;
+	int num_failed;
+
+	// Proof logging (opts.proof). For LRAT every clause has an id, kept in a
+	// table indexed by its arena offset, and every level-0 literal the id of
+	// its unit clause.
+	int lrat;
+	uint64_t *clause_id;
+	size_t clause_id_cap;
+	uint64_t *unit_id;      // per variable, 0 until derived
+	uint64_t *hints;        // antecedents of the clause being derived
+	int *hint_pos;          // per variable: next reason literal to visit
+	int units_logged;       // level-0 trail prefix whose unit ids are known
+} SolverCtx;
+
+#define GAUSS_REASON_TAG 0x80000000u
+
+// Room for decision levels: one per variable plus one per assumption
+#define MAX_LEVELS(nv) (2 * ((nv) + 1))
+
+// Out of time, or another thread asked the search to stop
+static int timed_out(const SolverCtx *ctx) {
+	if (ctx->opts.stop && *ctx->opts.stop) return 1;
+	if (ctx->timeout_ms <= 0) return 0;
+	return wall_ms() - ctx->start_ms > (double)ctx->timeout_ms;
+}
+
+static int watch_push(WatchList *ws, ClauseRef ref) {
+	if (ws->size == ws->capacity) {
+		int new_cap = ws->capacity ? ws->capacity * 2 : 4;
+		ClauseRef *arr = (ClauseRef *)realloc(ws->refs, (size_t)new_cap * sizeof(ClauseRef));
+		if (!arr) return -1;
+		ws->refs = arr;
+		ws->capacity = new_cap;
+	}
+	ws->refs[ws->size++] = ref;
+	return 0;
+}
+
+static int bin_push(BinList *bl, int other, ClauseRef ref) {
+	if (bl->size == bl->capacity) {
+		int new_cap = bl->capacity ? bl->capacity * 2 : 4;
+		BinWatch *arr = (BinWatch *)realloc(bl->data, (size_t)new_cap * sizeof(BinWatch));
+		if (!arr) return -1;
+		bl->data = arr;
+		bl->capacity = new_cap;
+	}
+	bl->data[bl->size].other = other;
+	bl->data[bl->size].ref = ref;
+	bl->size++;
+	return 0;
+}
+
+static int refvec_push(RefVec *v, ClauseRef ref) {
+	if (v->size == v->capacity) {
+		size_t new_cap = v->capacity ? v->capacity * 2 : 256;
+		ClauseRef *arr = (ClauseRef *)realloc(v->data, new_cap * sizeof(ClauseRef));
+		if (!arr) return -1;
+		v->data = arr;
+		v->capacity = new_cap;
+	}
+	v->data[v->size++] = ref;
+	return 0;
+}
+
+static inline ArenaClause *clause_at(const SolverCtx *ctx, ClauseRef ref) {
+	return arena_clause(&ctx->arena, ref);
+}
+
+// Reason or conflict clause, in either arena
+static inline const ArenaClause *reason_at(const SolverCtx *ctx, ClauseRef ref) {
+	if (ref & GAUSS_REASON_TAG) return arena_clause(&ctx->gauss_reasons, ref & ~GAUSS_REASON_TAG);
+	return arena_clause(&ctx->arena, ref);
+}
+
+static inline int clause_tier(const ArenaClause *c) {
+	return (c->flags & CLAUSE_TIER_MASK) >> CLAUSE_TIER_SHIFT;
+}
+
+static inline void set_clause_tier(ArenaClause *c, int tier) {
+	c->flags = (uint16_t)((c->flags & ~CLAUSE_TIER_MASK) | (tier << CLAUSE_TIER_SHIFT));
+}
+
+static int attach_clause(SolverCtx *ctx, ClauseRef ref) {
+	const ArenaClause *c = clause_at(ctx, ref);
+	if (c->size == 2) {
+		if (bin_push(&ctx->bins[c->lits[0]], c->lits[1], ref) != 0 ||
+			bin_push(&ctx->bins[c->lits[1]], c->lits[0], ref) != 0) {
+			return -1;
+		}
+		return 0;
+	}
+	if (watch_push(&ctx->watches[c->lits[0]], ref) != 0 ||
+		watch_push(&ctx->watches[c->lits[1]], ref) != 0) {
+		return -1;
+	}
+	return 0;
+}
+
+static int tier_for_lbd(const SolverCtx *ctx, int lbd) {
+	if (lbd <= ctx->opts.core_lbd) return TIER_CORE;
+	if (lbd <= ctx->opts.tier2_lbd) return TIER_TIER2;
+	return TIER_LOCAL;
+}
+
+// Store a learned clause of n >= 2 literals in the arena and watch it.
+// Returns its reference, or CLAUSE_REF_UNDEF on allocation failure.
+static ClauseRef add_learnt_clause(SolverCtx *ctx, const int *lits, int n, int lbd) {
+	ClauseRef ref = arena_alloc(&ctx->arena, lits, (uint32_t)n);
+	if (ref == CLAUSE_REF_UNDEF) return ref;
+	ArenaClause *c = clause_at(ctx, ref);
+	c->flags = ARENA_CLAUSE_LEARNT;
+	c->lbd = (uint16_t)(lbd > 0xFFFF ? 0xFFFF : lbd);
+	set_clause_tier(c, tier_for_lbd(ctx, lbd));
+	if (refvec_push(&ctx->learnts, ref) != 0 || attach_clause(ctx, ref) != 0) return CLAUSE_REF_UNDEF;
+	return ref;
+}
+
+// Record the LRAT id of the clause at 'ref'. Returns 0, -1 on allocation failure.
+static int set_clause_id(SolverCtx *ctx, ClauseRef ref, uint64_t id) {
+	if (ref >= ctx->clause_id_cap) {
+		size_t cap = ctx->arena.cap > ref ? ctx->arena.cap : (size_t)ref + 1;
+		uint64_t *ids = (uint64_t *)realloc(ctx->clause_id, cap * sizeof(uint64_t));
+		if (!ids) return -1;
+		ctx->clause_id = ids;
+		ctx->clause_id_cap = cap;
+	}
+	ctx->clause_id[ref] = id;
+	return 0;
+}
+
+static void heap_swap(VarHeap *h, int i, int j) {
+	int a = h->heap[i], b = h->heap[j];
+	h->heap[i] = b; h->pos[b] = i;
+	h->heap[j] = a; h->pos[a] = j;
+}
+
+static void heap_up(VarHeap *h, const double *act, int i) {
+	while (i > 0) {
+		int parent = (i - 1) >> 1;
+		if (act[h->heap[parent]] >= act[h->heap[i]]) break;
+		heap_swap(h, i, parent);
+		i = parent;
+	}
+}
+
+static void heap_down(VarHeap *h, const double *act, int i) {
+	for (;;) {
+		int l = 2 * i + 1, r = l + 1, best = i;
+		if (l < h->size && act[h->heap[l]] > act[h->heap[best]]) best = l;
+		if (r < h->size && act[h->heap[r]] > act[h->heap[best]]) best = r;
+		if (best == i) break;
+		heap_swap(h, i, best);
+		i = best;
+	}
+}
+
+static void heap_insert(VarHeap *h, const double *act, int v) {
+	if (h->pos[v] >= 0) return;
+	h->heap[h->size] = v;
+	h->pos[v] = h->size++;
+	heap_up(h, act, h->pos[v]);
+}
+
+static int heap_pop(VarHeap *h, const double *act) {
+	int top = h->heap[0];
+	h->pos[top] = -1;
+	if (--h->size > 0) {
+		h->heap[0] = h->heap[h->size];
+		h->pos[h->heap[0]] = 0;
+		heap_down(h, act, 0);
+	}
+	return top;
+}
+
+// EVSIDS bump; rescales every activity when values approach overflow
+static void bump_var(SolverCtx *ctx, int v) {
+	if ((ctx->activity[v] += ctx->var_inc) > 1e100) {
+		for (int i = 1; i <= ctx->num_vars; ++i) ctx->activity[i] *= 1e-100;
+		ctx->var_inc *= 1e-100;
+	}
+	if (ctx->order.pos[v] >= 0) heap_up(&ctx->order, ctx->activity, ctx->order.pos[v]);
+}
+
+static void decay_var_activity(SolverCtx *ctx) {
+	ctx->var_inc /= ctx->opts.var_decay;
+}
+
+static void enqueue(SolverCtx *ctx, int lit, ClauseRef reason) {
 	int v = lit_var(lit);
-	int val = as->values[v];
-	if (val == 0) return 0;
-	return (val == lit_sign(lit)) ? 1 : -1;
-}
-
-// Unit propagation: returns 1 if consistent, 0 if conflict. Also detects empty formula success.
-// Uses a simple loop scanning all clauses until no changes.
-static int unit_propagate(const CNF *cnf, Assignment *as) {
-	int changed = 1;
-	while (changed) {
-		changed = 0;
-		for (size_t i = 0; i < cnf->num_clauses; ++i) {
-			const Clause *cl = &cnf->clauses[i];
-			int num_unassigned = 0;
-			int last_unassigned_lit = 0;
-			int clause_satisfied = 0;
-			for (size_t j = 0; j < cl->num_literals; ++j) {
-				int lit = cl->literals[j];
-				int val = eval_lit(as, lit);
-				if (val == 1) { clause_satisfied = 1; break; }
-				if (val == 0) { num_unassigned++; last_unassigned_lit = lit; }
-			}
-			if (clause_satisfied) continue;
-			if (num_unassigned == 0) {
-				// Clause falsified under current partial assignment
+	ctx->vals[lit] = LIT_TRUE;
+	ctx->vals[lit_not(lit)] = LIT_FALSE;
+	ctx->level[v] = ctx->num_levels;
+	ctx->reason[v] = reason;
+	ctx->trail[ctx->trail_size++] = lit;
+}
+
+// Unassign everything placed on the trail after position 'mark'
+static void unassign_until(SolverCtx *ctx, int mark) {
+	for (int i = ctx->trail_size - 1; i >= mark; --i) {
+		int lit = ctx->trail[i];
+		int v = lit_var(lit);
+		ctx->saved_phase[v] = lit_phase(lit);
+		ctx->vals[lit] = LIT_UNDEF;
+		ctx->vals[lit_not(lit)] = LIT_UNDEF;
+		if (ctx->order.pos) heap_insert(&ctx->order, ctx->activity, v);
+		if (v < ctx->static_next) ctx->static_next = v;
+	}
+	ctx->trail_size = mark;
+	ctx->qhead = mark;
+	ctx->bin_qhead = mark;
+}
+
+// Drop all decision levels above 'lvl'
+static void cancel_until(SolverCtx *ctx, int lvl) {
+	if (ctx->num_levels <= lvl) return;
+	unassign_until(ctx, ctx->trail_lim[lvl]);
+	ctx->num_levels = lvl;
+	if (ctx->gauss.num_rows) {
+		gauss_backtrack(&ctx->gauss);
+		ctx->gauss_reasons.size = ctx->gauss_lim[lvl];
+	}
+}
+
+// Binary implications of every pending trail literal. Returns 1 if
+// consistent, 0 on conflict.
+static int propagate_binary(SolverCtx *ctx) {
+	while (ctx->bin_qhead < ctx->trail_size) {
+		int false_lit = lit_not(ctx->trail[ctx->bin_qhead++]);
+		const BinList *bl = &ctx->bins[false_lit];
+		for (int i = 0; i < bl->size; ++i) {
+			int other = bl->data[i].other;
+			int val = ctx->vals[other];
+			if (val == LIT_TRUE) continue;
+			if (val == LIT_FALSE) {
+				ctx->bin_qhead = ctx->trail_size;
+				ctx->qhead = ctx->trail_size;
+				ctx->conflict = bl->data[i].ref;
 				return 0;
 			}
-			if (num_unassigned == 1) {
-				int var = lit_var(last_unassigned_lit);
-				int sign = lit_sign(last_unassigned_lit);
-				if (as->values[var] == 0) {
-					as->values[var] = sign;
-					changed = 1;
-				} else if (as->values[var] != sign) {
-					return 0;
+			enqueue(ctx, other, bl->data[i].ref);
+		}
+	}
+	return 1;
+}
+
+// Unit propagation over the pending part of the trail. Binary clauses are
+// exhausted first for all pending literals, long clauses use two watched
+// literals. Returns 1 if consistent, 0 on conflict (clause stored in
+// ctx->conflict), -2 on allocation failure.
+static int unit_propagate(SolverCtx *ctx) {
+	for (;;) {
+		if (!propagate_binary(ctx)) return 0;
+		if (ctx->qhead >= ctx->trail_size) break;
+		int false_lit = lit_not(ctx->trail[ctx->qhead++]);
+		const int8_t *vals = ctx->vals;
+		ctx->stats.propagations++;
+		WatchList *ws = &ctx->watches[false_lit];
+		int i = 0, j = 0;
+		while (i < ws->size) {
+			ClauseRef ci = ws->refs[i++];
+			ArenaClause *c = clause_at(ctx, ci);
+			int *cl = c->lits;
+			int n = (int)c->size;
+			// Keep the falsified watch in slot 1
+			if (cl[0] == false_lit) { cl[0] = cl[1]; cl[1] = false_lit; }
+			if (vals[cl[0]] == LIT_TRUE) { ws->refs[j++] = ci; continue; }
+			int moved = 0;
+			for (int k = 2; k < n; ++k) {
+				if (vals[cl[k]] != LIT_FALSE) {
+					cl[1] = cl[k];
+					cl[k] = false_lit;
+					if (watch_push(&ctx->watches[cl[1]], ci) != 0) {
+						while (i < ws->size) ws->refs[j++] = ws->refs[i++];
+						ws->size = j;
+						return -2;
+					}
+					moved = 1;
+					break;
 				}
 			}
+			if (moved) continue;
+			ws->refs[j++] = ci;
+			if (vals[cl[0]] == LIT_FALSE) {
+				// Clause falsified under current partial assignment
+				while (i < ws->size) ws->refs[j++] = ws->refs[i++];
+				ws->size = j;
+				ctx->qhead = ctx->trail_size;
+				ctx->bin_qhead = ctx->trail_size;
+				ctx->conflict = ci;
+				return 0;
+			}
+			// Implied literal stays in slot 0 while it is assigned
+			enqueue(ctx, cl[0], ci);
 		}
+		ws->size = j;
 	}
 	return 1;
 }
 
-static int choose_unassigned_variable(const CNF *cnf, const Assignment *as) {
-	for (int v = 1; v <= cnf->num_variables; ++v) {
-		if (as->values[v] == 0) return v;
+// Static order: lowest-numbered unassigned variable. The cursor only moves
+// back when backtracking unassigns a smaller variable.
+static int choose_unassigned_variable(SolverCtx *ctx) {
+	for (int v = ctx->static_next; v <= ctx->num_vars; ++v) {
+		if (ctx->vals[mk_lit(v, 0)] == LIT_UNDEF) { ctx->static_next = v; return v; }
+	}
+	ctx->static_next = ctx->num_vars + 1;
+	return -1;
+}
+
+static unsigned long long next_random(SolverCtx *ctx) {
+	// xorshift64*
+	ctx->rng ^= ctx->rng >> 12;
+	ctx->rng ^= ctx->rng << 25;
+	ctx->rng ^= ctx->rng >> 27;
+	return ctx->rng * 2685821657736338717ULL;
+}
+
+// Remember the assignment of the conflict-free part of the trail if it is the
+// longest one so far. Called on conflict, before backjumping.
+static void update_target_phase(SolverCtx *ctx) {
+	int consistent = ctx->num_levels > 0 ? ctx->trail_lim[ctx->num_levels - 1] : ctx->trail_size;
+	if (consistent > ctx->target_size) {
+		for (int i = 0; i < consistent; ++i) {
+			int lit = ctx->trail[i];
+			ctx->target_phase[lit_var(lit)] = lit_phase(lit);
+		}
+		ctx->target_size = consistent;
+	}
+	if (consistent > ctx->best_size) {
+		for (int i = 0; i < consistent; ++i) {
+			int lit = ctx->trail[i];
+			ctx->best_phase[lit_var(lit)] = lit_phase(lit);
+		}
+		ctx->best_size = consistent;
+	}
+}
+
+// Literal to branch on for 'var' under the configured polarity policy
+static int choose_polarity(SolverCtx *ctx, int var) {
+	int sign;
+	switch (ctx->opts.phase) {
+	case PHASE_FALSE: sign = -1; break;
+	case PHASE_TRUE: sign = 1; break;
+	case PHASE_RANDOM: sign = (next_random(ctx) >> 32) & 1 ? 1 : -1; break;
+	case PHASE_TARGET:
+		sign = ctx->target_phase[var] ? ctx->target_phase[var] : ctx->saved_phase[var];
+		break;
+	case PHASE_BEST:
+		sign = ctx->best_phase[var] ? ctx->best_phase[var] : ctx->saved_phase[var];
+		break;
+	case PHASE_SAVED:
+	default: sign = ctx->saved_phase[var]; break;
+	}
+	return mk_lit(var, sign < 0);
+}
+
+// Unassigned variable with the highest activity; assigned ones are dropped lazily
+static int choose_branch_variable(SolverCtx *ctx) {
+	if (ctx->opts.decision == DECIDE_STATIC) return choose_unassigned_variable(ctx);
+	while (ctx->order.size > 0) {
+		int v = heap_pop(&ctx->order, ctx->activity);
+		if (ctx->vals[mk_lit(v, 0)] == LIT_UNDEF) return v;
 	}
 	return -1;
 }
 
-static int all_clauses_satisfied(const CNF *cnf, const Assignment *as) {
+static void free_ctx(SolverCtx *ctx) {
+	if (ctx->watches) {
+		for (int i = 0; i < 2 * (ctx->num_vars + 1); ++i) free(ctx->watches[i].refs);
+	}
+	if (ctx->bins) {
+		for (int i = 0; i < 2 * (ctx->num_vars + 1); ++i) free(ctx->bins[i].data);
+	}
+	free(ctx->watches);
+	free(ctx->bins);
+	free(ctx->vals);
+	arena_free(&ctx->arena);
+	free(ctx->originals.data);
+	free(ctx->learnts.data);
+	free(ctx->trail);
+	free(ctx->trail_lim);
+	free(ctx->flipped);
+	free(ctx->level);
+	free(ctx->reason);
+	free(ctx->seen);
+	free(ctx->learnt);
+	free(ctx->analyze_stack);
+	free(ctx->analyze_clear);
+	free(ctx->activity);
+	free(ctx->order.heap);
+	free(ctx->order.pos);
+	free(ctx->saved_phase);
+	free(ctx->target_phase);
+	free(ctx->best_phase);
+	free(ctx->level_stamp);
+	gauss_free(&ctx->gauss);
+	arena_free(&ctx->gauss_reasons);
+	free(ctx->gauss_lim);
+	free(ctx->assumptions);
+	free(ctx->failed);
+	free(ctx->clause_id);
+	free(ctx->unit_id);
+	free(ctx->hints);
+	free(ctx->hint_pos);
+}
+
+// Allocate all per-variable search state. Returns 0 on success.
+static int init_ctx(SolverCtx *ctx, int nv) {
+	ctx->num_vars = nv;
+	ctx->watches = (WatchList *)calloc((size_t)2 * (size_t)(nv + 1), sizeof(WatchList));
+	ctx->bins = (BinList *)calloc((size_t)2 * (size_t)(nv + 1), sizeof(BinList));
+	ctx->vals = (int8_t *)calloc((size_t)2 * (size_t)(nv + 1), sizeof(int8_t));
+	ctx->trail = (int *)malloc((size_t)(nv + 1) * sizeof(int));
+	// Levels of assumptions that already hold are empty, so there may be up
+	// to 2 * nv of them
+	ctx->trail_lim = (int *)malloc((size_t)MAX_LEVELS(nv) * sizeof(int));
+	ctx->flipped = (unsigned char *)malloc((size_t)MAX_LEVELS(nv));
+	ctx->level = (int *)calloc((size_t)(nv + 1), sizeof(int));
+	ctx->reason = (ClauseRef *)malloc((size_t)(nv + 1) * sizeof(ClauseRef));
+	ctx->seen = (unsigned char *)calloc((size_t)(nv + 1), 1);
+	ctx->learnt = (int *)malloc((size_t)(nv + 1) * sizeof(int));
+	ctx->analyze_stack = (int *)malloc((size_t)(nv + 1) * sizeof(int));
+	ctx->analyze_clear = (int *)malloc((size_t)(nv + 1) * sizeof(int));
+	ctx->activity = (double *)calloc((size_t)(nv + 1), sizeof(double));
+	ctx->order.heap = (int *)malloc((size_t)(nv + 1) * sizeof(int));
+	ctx->order.pos = (int *)malloc((size_t)(nv + 1) * sizeof(int));
+	ctx->saved_phase = (signed char *)malloc((size_t)(nv + 1));
+	ctx->target_phase = (signed char *)calloc((size_t)(nv + 1), 1);
+	ctx->best_phase = (signed char *)calloc((size_t)(nv + 1), 1);
+	ctx->level_stamp = (unsigned *)calloc((size_t)MAX_LEVELS(nv) + 1, sizeof(unsigned));
+	if (!ctx->watches || !ctx->bins || !ctx->vals || !ctx->trail || !ctx->trail_lim || !ctx->flipped || !ctx->level ||
+		!ctx->reason || !ctx->seen || !ctx->learnt || !ctx->analyze_stack || !ctx->analyze_clear ||
+		!ctx->activity || !ctx->order.heap || !ctx->order.pos || !ctx->saved_phase ||
+		!ctx->target_phase || !ctx->best_phase || !ctx->level_stamp) {
+		return -1;
+	}
+	// All activities start equal, so the heap initially yields variables in index order
+	ctx->var_inc = 1.0;
+	ctx->cla_inc = 1.0f;
+	ctx->reduce_interval = (unsigned long)ctx->opts.reduce_first;
+	ctx->next_reduce = ctx->reduce_interval;
+	ctx->static_next = 1;
+	memset(ctx->saved_phase, ctx->opts.initial_phase > 0 ? 1 : -1, (size_t)(nv + 1));
+	ctx->rng = ctx->opts.seed ? ctx->opts.seed : 0x9E3779B97F4A7C15ULL;
+	ctx->order.size = 0;
+	ctx->order.pos[0] = -1;
+	for (int v = 1; v <= nv; ++v) {
+		ctx->order.heap[ctx->order.size] = v;
+		ctx->order.pos[v] = ctx->order.size++;
+	}
+	if (ctx->opts.shuffle_order) {
+		// Equal activities make any order a valid heap: break the ties at random
+		for (int i = nv - 1; i > 0; --i) {
+			int j = (int)(next_random(ctx) % (unsigned long long)(i + 1));
+			int a = ctx->order.heap[i], b = ctx->order.heap[j];
+			ctx->order.heap[i] = b;
+			ctx->order.heap[j] = a;
+			ctx->order.pos[b] = i;
+			ctx->order.pos[a] = j;
+		}
+	}
+	return 0;
+}
+
+// Resize *p from old_n to new_n elements, zeroing the new ones
+static int grow_zeroed(void **p, size_t old_n, size_t new_n, size_t elem) {
+	void *q = realloc(*p, new_n * elem);
+	if (!q) return -1;
+	memset((char *)q + old_n * elem, 0, (new_n - old_n) * elem);
+	*p = q;
+	return 0;
+}
+
+// Make room for variables up to nv (incremental use, at level 0): every
+// per-variable array grows, new variables join the decision heap unassigned
+static int grow_vars(SolverCtx *ctx, int nv) {
+	size_t o = (size_t)ctx->num_vars + 1, n = (size_t)nv + 1;
+	if (grow_zeroed((void **)&ctx->watches, 2 * o, 2 * n, sizeof(WatchList)) != 0 ||
+		grow_zeroed((void **)&ctx->bins, 2 * o, 2 * n, sizeof(BinList)) != 0 ||
+		grow_zeroed((void **)&ctx->vals, 2 * o, 2 * n, sizeof(int8_t)) != 0 ||
+		grow_zeroed((void **)&ctx->trail, o, n, sizeof(int)) != 0 ||
+		grow_zeroed((void **)&ctx->trail_lim, MAX_LEVELS(o - 1), MAX_LEVELS(n - 1), sizeof(int)) != 0 ||
+		grow_zeroed((void **)&ctx->flipped, MAX_LEVELS(o - 1), MAX_LEVELS(n - 1), 1) != 0 ||
+		grow_zeroed((void **)&ctx->level, o, n, sizeof(int)) != 0 ||
+		grow_zeroed((void **)&ctx->reason, o, n, sizeof(ClauseRef)) != 0 ||
+		grow_zeroed((void **)&ctx->seen, o, n, 1) != 0 ||
+		grow_zeroed((void **)&ctx->learnt, o, n, sizeof(int)) != 0 ||
+		grow_zeroed((void **)&ctx->analyze_stack, o, n, sizeof(int)) != 0 ||
+		grow_zeroed((void **)&ctx->analyze_clear, o, n, sizeof(int)) != 0 ||
+		grow_zeroed((void **)&ctx->activity, o, n, sizeof(double)) != 0 ||
+		grow_zeroed((void **)&ctx->order.heap, o, n, sizeof(int)) != 0 ||
+		grow_zeroed((void **)&ctx->order.pos, o, n, sizeof(int)) != 0 ||
+		grow_zeroed((void **)&ctx->saved_phase, o, n, 1) != 0 ||
+		grow_zeroed((void **)&ctx->target_phase, o, n, 1) != 0 ||
+		grow_zeroed((void **)&ctx->best_phase, o, n, 1) != 0 ||
+		grow_zeroed((void **)&ctx->level_stamp, MAX_LEVELS(o - 1) + 1, MAX_LEVELS(n - 1) + 1, sizeof(unsigned)) != 0 ||
+		grow_zeroed((void **)&ctx->failed, o + 1, n + 1, sizeof(int)) != 0) {
+		return -1;
+	}
+	if (ctx->gauss_lim &&
+		grow_zeroed((void **)&ctx->gauss_lim, MAX_LEVELS(o - 1), MAX_LEVELS(n - 1), sizeof(uint32_t)) != 0) {
+		return -1;
+	}
+	if (gauss_grow_vars(&ctx->gauss, ctx->num_vars, nv) != 0) return -1;
+	for (int v = ctx->num_vars + 1; v <= nv; ++v) {
+		ctx->saved_phase[v] = ctx->opts.initial_phase > 0 ? 1 : -1;
+		ctx->order.pos[v] = -1;
+		heap_insert(&ctx->order, ctx->activity, v);
+	}
+	ctx->num_vars = nv;
+	return 0;
+}
+
+// Fill the arena with the clauses of a per-clause CNF
+static int load_cnf(SolverCtx *ctx, const CNF *cnf, RefVec *refs) {
+	size_t total = 0;
+	for (size_t i = 0; i < cnf->num_clauses; ++i) total += arena_clause_words((uint32_t)cnf->clauses[i].num_literals);
+	if (arena_init(&ctx->arena, total) != 0) return -1;
 	for (size_t i = 0; i < cnf->num_clauses; ++i) {
-		const Clause *cl = &cnf->clauses[i];
-		int sat = 0;
-		for (size_t j = 0; j < cl->num_literals; ++j) {
-			if (eval_lit(as, cl->literals[j]) == 1) { sat = 1; break; }
+		const Clause *src = &cnf->clauses[i];
+		ClauseRef ref = arena_alloc(&ctx->arena, src->literals, (uint32_t)src->num_literals);
+		if (ref == CLAUSE_REF_UNDEF || refvec_push(refs, ref) != 0) return -1;
+	}
+	return 0;
+}
+
+// Input clause 'id' is empty, or a unit contradicting the unit 'unit_id':
+// log the empty clause and report UNSAT
+static int log_trivial_unsat(SolverCtx *ctx, uint64_t id, uint64_t unit_id) {
+	if (!ctx->opts.proof) return 0;
+	uint64_t hints[2];
+	int nh = 0;
+	if (unit_id) hints[nh++] = unit_id;
+	hints[nh++] = id;
+	proof_add(ctx->opts.proof, NULL, 0, hints, nh);
+	return 0;
+}
+
+// Normalize the original clauses in place: convert DIMACS literals to the
+// packed encoding, drop duplicate literals and tautologies, enqueue unit
+// clauses at level 0 and watch the rest.
+// Returns 1 if ready, 0 if the formula is trivially UNSAT, -2 on error.
+static int attach_originals(SolverCtx *ctx, const ClauseRef *refs, size_t count) {
+	int nv = ctx->num_vars;
+	unsigned char *mark = ctx->seen; // per-variable polarity mark while scanning
+	for (size_t i = 0; i < count; ++i) {
+		ArenaClause *c = clause_at(ctx, refs[i]);
+		uint32_t n = 0;
+		int tautology = 0;
+		for (uint32_t j = 0; j < c->size; ++j) {
+			int d = c->lits[j];
+			int v = d > 0 ? d : -d;
+			if (v < 1 || v > nv) { tautology = -1; break; }
+			unsigned char m = d > 0 ? 1 : 2;
+			if (mark[v] == m) continue;
+			if (mark[v]) { tautology = 1; break; }
+			mark[v] = m;
+			c->lits[n++] = lit_from_dimacs(d);
 		}
-		if (!sat) return 0;
+		for (uint32_t k = 0; k < n; ++k) mark[lit_var(c->lits[k])] = 0;
+		if (tautology == -1) return -2;
+		// Literals dropped from the tail become waste until the next compaction
+		ctx->arena.wasted += c->size - n;
+		c->size = n;
+		if (tautology) { arena_delete(&ctx->arena, refs[i]); continue; }
+
+		// LRAT numbers the input clauses from 1 in order
+		uint64_t id = (uint64_t)i + 1;
+		if (n == 0) return log_trivial_unsat(ctx, id, 0);
+		if (n == 1) {
+			int lit = c->lits[0];
+			int val = ctx->vals[lit];
+			arena_delete(&ctx->arena, refs[i]);
+			if (val == LIT_FALSE) return log_trivial_unsat(ctx, id, ctx->lrat ? ctx->unit_id[lit_var(lit)] : 0);
+			if (val == LIT_UNDEF) {
+				enqueue(ctx, lit, CLAUSE_REF_UNDEF);
+				if (ctx->lrat) ctx->unit_id[lit_var(lit)] = id;
+			}
+			continue;
+		}
+		c->flags = 0;
+		if (refvec_push(&ctx->originals, refs[i]) != 0 || attach_clause(ctx, refs[i]) != 0) return -2;
+		if (ctx->lrat && set_clause_id(ctx, refs[i], id) != 0) return -2;
 	}
 	return 1;
 }
 
-typedef struct SolverCtx {
-	const CNF *cnf;
-	Assignment *assignment;
-	clock_t start_clock;
-	long timeout_ms; // <= 0 means no timeout
-} SolverCtx;
+// Open a decision level; an assumption that already holds gets one with no literal
+static void new_level(SolverCtx *ctx, unsigned char flipped) {
+	ctx->trail_lim[ctx->num_levels] = ctx->trail_size;
+	if (ctx->gauss_lim) ctx->gauss_lim[ctx->num_levels] = ctx->gauss_reasons.size;
+	ctx->flipped[ctx->num_levels] = flipped;
+	ctx->num_levels++;
+}
 
-static int timed_out(const SolverCtx *ctx) {
-	if (ctx->timeout_ms <= 0) return 0;
-	clock_t now = clock();
-	double elapsed_ms = (double)(now - ctx->start_clock) * 1000.0 / (double)CLOCKS_PER_SEC;
-	return elapsed_ms > (double)ctx->timeout_ms;
+static void new_decision(SolverCtx *ctx, int lit, unsigned char flipped) {
+	new_level(ctx, flipped);
+	enqueue(ctx, lit, CLAUSE_REF_UNDEF);
+}
+
+// Chronological backtracking: pop levels until one whose decision has not been
+// negated yet, then retry it with the opposite polarity. Returns 0 when every
+// level is exhausted.
+static int backtrack(SolverCtx *ctx) {
+	while (ctx->num_levels > 0) {
+		int d = --ctx->num_levels;
+		int decision = ctx->trail[ctx->trail_lim[d]];
+		unassign_until(ctx, ctx->trail_lim[d]);
+		if (!ctx->flipped[d]) {
+			new_decision(ctx, lit_not(decision), 1);
+			return 1;
+		}
+	}
+	return 0;
+}
+
+// Iterative DPLL search driven by the trail; no recursion and no allocation per node.
+static int dpll_search(SolverCtx *ctx) {
+	unsigned long nodes = 0;
+	for (;;) {
+		if ((++nodes & 255) == 0 && timed_out(ctx)) return -1;
+		int p = unit_propagate(ctx);
+		if (p == -2) return -2;
+		if (p == 0) {
+			ctx->stats.conflicts++;
+			if (!backtrack(ctx)) return 0;
+			continue;
+		}
+		int var = choose_unassigned_variable(ctx);
+		if (var == -1) return 1;
+		ctx->stats.decisions++;
+		// Branch var = True first; backtrack() tries var = False
+		new_decision(ctx, mk_lit(var, 0), 0);
+	}
+}
+
+// Literal block distance: number of distinct decision levels in a clause
+static int compute_lbd(SolverCtx *ctx, const int *lits, int n) {
+	if (++ctx->stamp == 0) {
+		memset(ctx->level_stamp, 0, ((size_t)MAX_LEVELS(ctx->num_vars) + 1) * sizeof(unsigned));
+		ctx->stamp = 1;
+	}
+	int lbd = 0;
+	for (int k = 0; k < n; ++k) {
+		int lv = ctx->level[lit_var(lits[k])];
+		if (ctx->level_stamp[lv] != ctx->stamp) {
+			ctx->level_stamp[lv] = ctx->stamp;
+			lbd++;
+		}
+	}
+	return lbd;
+}
+
+static void bump_clause(SolverCtx *ctx, ArenaClause *c) {
+	if ((c->u.activity += ctx->cla_inc) > 1e20f) {
+		for (size_t k = 0; k < ctx->learnts.size; ++k) clause_at(ctx, ctx->learnts.data[k])->u.activity *= 1e-20f;
+		ctx->cla_inc *= 1e-20f;
+	}
+}
+
+// A learned clause took part in conflict analysis: mark it used, bump its
+// activity and promote it if its LBD under the current assignment dropped.
+static void touch_learned(SolverCtx *ctx, ClauseRef ref) {
+	ArenaClause *c = clause_at(ctx, ref);
+	if (!(c->flags & ARENA_CLAUSE_LEARNT)) return;
+	c->flags |= CLAUSE_USED;
+	bump_clause(ctx, c);
+	if (c->lbd > ctx->opts.core_lbd) {
+		int lbd = compute_lbd(ctx, c->lits, (int)c->size);
+		if (lbd < c->lbd) {
+			c->lbd = (uint16_t)lbd;
+			int tier = tier_for_lbd(ctx, lbd);
+			if (tier > clause_tier(c)) set_clause_tier(c, tier);
+		}
+	}
+}
+
+// Bit signature of the decision levels in a set, used to prune minimization
+static inline unsigned abstract_level(const SolverCtx *ctx, int v) {
+	return 1u << (ctx->level[v] & 31);
+}
+
+// Check whether literal 'lit' of the learned clause is implied by the other
+// literals (its reason chain ends only in seen variables). Iterative DFS over
+// reasons; marks visited variables so later queries reuse the result.
+static int lit_redundant(SolverCtx *ctx, int lit, unsigned abstract_levels) {
+	int top = ctx->num_clear;
+	int sp = 0;
+	ctx->analyze_stack[sp++] = lit;
+	while (sp > 0) {
+		int q = ctx->analyze_stack[--sp];
+		const ArenaClause *c = reason_at(ctx, ctx->reason[lit_var(q)]);
+		const int *cl = c->lits;
+		int n = (int)c->size;
+		for (int k = 0; k < n; ++k) {
+			int v = lit_var(cl[k]);
+			if (v == lit_var(q) || ctx->seen[v] || ctx->level[v] == 0) continue;
+			if (ctx->reason[v] != CLAUSE_REF_UNDEF && (abstract_level(ctx, v) & abstract_levels) != 0) {
+				ctx->seen[v] = 1;
+				ctx->analyze_stack[sp++] = cl[k];
+				ctx->analyze_clear[ctx->num_clear++] = v;
+			} else {
+				// Reached a decision or a level outside the clause: not redundant
+				for (int t = top; t < ctx->num_clear; ++t) ctx->seen[ctx->analyze_clear[t]] = 0;
+				ctx->num_clear = top;
+				return 0;
+			}
+		}
+	}
+	return 1;
+}
+
+// First-UIP conflict analysis with recursive clause minimization.
+// Leaves the learned clause in ctx->learnt (asserting literal first, a literal
+// of the backjump level second) and returns its length; *out_level receives
+// the backjump level.
+static int analyze(SolverCtx *ctx, int *out_level) {
+	int path = 0;
+	int p = 0;
+	int n = 1; // slot 0 reserved for the asserting literal
+	int idx = ctx->trail_size - 1;
+	ClauseRef ci = ctx->conflict;
+	ctx->num_clear = 0;
+	do {
+		if (!(ci & GAUSS_REASON_TAG)) touch_learned(ctx, ci);
+		const ArenaClause *c = reason_at(ctx, ci);
+		const int *cl = c->lits;
+		int size = (int)c->size;
+		for (int k = 0; k < size; ++k) {
+			int q = cl[k];
+			int v = lit_var(q);
+			if (q == p || ctx->seen[v] || ctx->level[v] == 0) continue;
+			ctx->seen[v] = 1;
+			ctx->analyze_clear[ctx->num_clear++] = v;
+			bump_var(ctx, v);
+			if (ctx->level[v] >= ctx->num_levels) path++;
+			else ctx->learnt[n++] = q;
+		}
+		// Walk back to the next marked literal of the current level
+		while (!ctx->seen[lit_var(ctx->trail[idx])]) idx--;
+		p = ctx->trail[idx--];
+		ci = ctx->reason[lit_var(p)];
+		ctx->seen[lit_var(p)] = 0;
+		path--;
+	} while (path > 0);
+	ctx->learnt[0] = lit_not(p);
+
+	// Drop literals implied by the rest of the clause
+	unsigned abstract_levels = 0;
+	for (int k = 1; k < n; ++k) abstract_levels |= abstract_level(ctx, lit_var(ctx->learnt[k]));
+	int m = 1;
+	for (int k = 1; k < n; ++k) {
+		int v = lit_var(ctx->learnt[k]);
+		if (ctx->reason[v] == CLAUSE_REF_UNDEF || !lit_redundant(ctx, ctx->learnt[k], abstract_levels)) {
+			ctx->learnt[m++] = ctx->learnt[k];
+		}
+	}
+	n = m;
+
+	// Backjump to the highest level among the remaining literals
+	int bt = 0;
+	if (n > 1) {
+		int best = 1;
+		for (int k = 2; k < n; ++k) {
+			if (ctx->level[lit_var(ctx->learnt[k])] > ctx->level[lit_var(ctx->learnt[best])]) best = k;
+		}
+		int tmp = ctx->learnt[1];
+		ctx->learnt[1] = ctx->learnt[best];
+		ctx->learnt[best] = tmp;
+		bt = ctx->level[lit_var(ctx->learnt[1])];
+	}
+	for (int k = 0; k < ctx->num_clear; ++k) ctx->seen[ctx->analyze_clear[k]] = 0;
+	ctx->num_clear = 0;
+	*out_level = bt;
+	return n;
+}
+
+// Give every level-0 literal propagated since the last call its own unit
+// clause, derived from its reason and the units before it on the trail
+static void lrat_level0_units(SolverCtx *ctx) {
+	for (; ctx->units_logged < ctx->trail_size; ++ctx->units_logged) {
+		int lit = ctx->trail[ctx->units_logged];
+		int v = lit_var(lit);
+		if (ctx->unit_id[v]) continue;
+		const ArenaClause *c = clause_at(ctx, ctx->reason[v]);
+		int nh = 0;
+		for (uint32_t k = 0; k < c->size; ++k) {
+			int u = lit_var(c->lits[k]);
+			if (u != v) ctx->hints[nh++] = ctx->unit_id[u];
+		}
+		ctx->hints[nh++] = ctx->clause_id[ctx->reason[v]];
+		ctx->unit_id[v] = proof_add(ctx->opts.proof, &lit, 1, ctx->hints, nh);
+	}
+}
+
+// LRAT antecedents of the clause just learned (ctx->learnt, n literals):
+// units of the level-0 literals, then the reasons of the literals resolved
+// or minimized away in depth-first postorder, so each one is unit once the
+// clause is negated, and the conflict last. Returns their number.
+static int lrat_chain(SolverCtx *ctx, int n) {
+	uint64_t *units = ctx->hints;
+	uint64_t *chain = ctx->hints + ctx->num_vars + 1;
+	int nu = 0, nc = 0;
+	ctx->num_clear = 0;
+	for (int k = 0; k < n; ++k) {
+		int v = lit_var(ctx->learnt[k]);
+		ctx->seen[v] = 1;
+		ctx->analyze_clear[ctx->num_clear++] = v;
+	}
+	const ArenaClause *conflict = clause_at(ctx, ctx->conflict);
+	for (uint32_t i = 0; i < conflict->size; ++i) {
+		int root = lit_var(conflict->lits[i]);
+		if (ctx->seen[root]) continue;
+		ctx->seen[root] = 1;
+		ctx->analyze_clear[ctx->num_clear++] = root;
+		if (ctx->level[root] == 0) {
+			units[nu++] = ctx->unit_id[root];
+			continue;
+		}
+		int sp = 0;
+		ctx->analyze_stack[sp++] = root;
+		ctx->hint_pos[root] = 0;
+		while (sp > 0) {
+			int v = ctx->analyze_stack[sp - 1];
+			const ArenaClause *c = clause_at(ctx, ctx->reason[v]);
+			if (ctx->hint_pos[v] == (int)c->size) {
+				chain[nc++] = ctx->clause_id[ctx->reason[v]];
+				sp--;
+				continue;
+			}
+			int u = lit_var(c->lits[ctx->hint_pos[v]++]);
+			if (ctx->seen[u]) continue;
+			ctx->seen[u] = 1;
+			ctx->analyze_clear[ctx->num_clear++] = u;
+			if (ctx->level[u] == 0) {
+				units[nu++] = ctx->unit_id[u];
+			} else {
+				ctx->hint_pos[u] = 0;
+				ctx->analyze_stack[sp++] = u;
+			}
+		}
+	}
+	for (int k = 0; k < ctx->num_clear; ++k) ctx->seen[ctx->analyze_clear[k]] = 0;
+	ctx->num_clear = 0;
+	memmove(units + nu, chain, (size_t)nc * sizeof(uint64_t));
+	units[nu + nc] = ctx->clause_id[ctx->conflict];
+	return nu + nc + 1;
+}
+
+// Log the clause just learned, before backjumping. Returns its id.
+static uint64_t log_learnt(SolverCtx *ctx, int n) {
+	int nh = ctx->lrat ? lrat_chain(ctx, n) : 0;
+	return proof_add(ctx->opts.proof, ctx->learnt, n, ctx->hints, nh);
+}
+
+// Log the empty clause after a conflict at level 0
+static void log_empty(SolverCtx *ctx) {
+	int nh = 0;
+	if (ctx->lrat) {
+		lrat_level0_units(ctx);
+		const ArenaClause *c = clause_at(ctx, ctx->conflict);
+		for (uint32_t k = 0; k < c->size; ++k) ctx->hints[nh++] = ctx->unit_id[lit_var(c->lits[k])];
+		ctx->hints[nh++] = ctx->clause_id[ctx->conflict];
+	}
+	proof_add(ctx->opts.proof, NULL, 0, ctx->hints, nh);
 }
 
-static int dpll_recursive_ctx(SolverCtx *ctx) {
-	if (timed_out(ctx)) return -1;
-	if (!unit_propagate(ctx->cnf, ctx->assignment)) return 0;
-	if (all_clauses_satisfied(ctx->cnf, ctx->assignment)) return 1;
-	int var = choose_unassigned_variable(ctx->cnf, ctx->assignment);
-	if (var == -1) return 0;
+typedef struct ReduceCandidate {
+	ClauseRef ref;
+	int lbd;
+	float act;
+} ReduceCandidate;
+
+// Least useful first: lower activity, then higher LBD
+static int cmp_reduce_candidate(const void *a, const void *b) {
+	const ReduceCandidate *x = (const ReduceCandidate *)a;
+	const ReduceCandidate *y = (const ReduceCandidate *)b;
+	if (x->act != y->act) return x->act < y->act ? -1 : 1;
+	if (x->lbd != y->lbd) return x->lbd > y->lbd ? -1 : 1;
+	return x->ref < y->ref ? -1 : (x->ref > y->ref);
+}
+
+static int clause_locked(const SolverCtx *ctx, ClauseRef ref) {
+	int lit = clause_at(ctx, ref)->lits[0];
+	return ctx->vals[lit] != LIT_UNDEF && ctx->reason[lit_var(lit)] == ref;
+}
+
+// Drop watches of deleted clauses
+static void clean_watches(SolverCtx *ctx) {
+	for (int li = 0; li < 2 * (ctx->num_vars + 1); ++li) {
+		WatchList *ws = &ctx->watches[li];
+		int j = 0;
+		for (int i = 0; i < ws->size; ++i) {
+			if (!(clause_at(ctx, ws->refs[i])->flags & ARENA_CLAUSE_DELETED)) ws->refs[j++] = ws->refs[i];
+		}
+		ws->size = j;
+	}
+}
 
-	// Snapshot assignment for proper backtracking
-	int num = ctx->assignment->num_variables;
-	int *backup = (int *)malloc((size_t)(num + 1) * sizeof(int));
-	if (!backup) return -1;
-	memcpy(backup, ctx->assignment->values, (size_t)(num + 1) * sizeof(int));
+static ClauseRef relocate(ClauseArena *from, ClauseArena *to, ClauseRef ref) {
+	ArenaClause *c = arena_clause(from, ref);
+	if (c->flags & ARENA_CLAUSE_RELOCATED) return c->u.forward;
+	uint32_t words = arena_clause_words(c->size);
+	ClauseRef nref = to->size;
+	memcpy(to->mem + nref, from->mem + ref, (size_t)words * sizeof(uint32_t));
+	to->size += words;
+	c->flags |= ARENA_CLAUSE_RELOCATED;
+	c->u.forward = nref;
+	return nref;
+}
 
-	// Branch var = True
-	ctx->assignment->values[var] = 1;
-	int r = dpll_recursive_ctx(ctx);
-	if (r != 0) { free(backup); return (r == -1) ? -1 : 1; }
+// Compact the arena: copy live clauses (originals first, then learned clauses
+// in age order) into a fresh block and rewrite every reference through the
+// forwarding offsets left in the old headers.
+static int collect_garbage(SolverCtx *ctx) {
+	ClauseArena to;
+	if (arena_init(&to, (size_t)(ctx->arena.size - ctx->arena.wasted)) != 0) return -1;
+	// LRAT ids move along with their clauses
+	uint64_t *ids = NULL;
+	if (ctx->lrat) {
+		ids = (uint64_t *)malloc(((size_t)to.cap + 1) * sizeof(uint64_t));
+		if (!ids) {
+			arena_free(&to);
+			return -1;
+		}
+	}
+	for (size_t k = 0; k < ctx->originals.size; ++k) {
+		ClauseRef ref = ctx->originals.data[k];
+		ctx->originals.data[k] = relocate(&ctx->arena, &to, ref);
+		if (ids) ids[ctx->originals.data[k]] = ctx->clause_id[ref];
+	}
+	for (size_t k = 0; k < ctx->learnts.size; ++k) {
+		ClauseRef ref = ctx->learnts.data[k];
+		ctx->learnts.data[k] = relocate(&ctx->arena, &to, ref);
+		if (ids) ids[ctx->learnts.data[k]] = ctx->clause_id[ref];
+	}
+	if (ids) {
+		free(ctx->clause_id);
+		ctx->clause_id = ids;
+		ctx->clause_id_cap = (size_t)to.cap + 1;
+	}
+	for (int li = 0; li < 2 * (ctx->num_vars + 1); ++li) {
+		WatchList *ws = &ctx->watches[li];
+		for (int i = 0; i < ws->size; ++i) ws->refs[i] = arena_clause(&ctx->arena, ws->refs[i])->u.forward;
+		BinList *bl = &ctx->bins[li];
+		for (int i = 0; i < bl->size; ++i) bl->data[i].ref = arena_clause(&ctx->arena, bl->data[i].ref)->u.forward;
+	}
+	for (int i = 0; i < ctx->trail_size; ++i) {
+		int v = lit_var(ctx->trail[i]);
+		ClauseRef ref = ctx->reason[v];
+		if (ref != CLAUSE_REF_UNDEF && !(ref & GAUSS_REASON_TAG)) ctx->reason[v] = arena_clause(&ctx->arena, ref)->u.forward;
+	}
+	arena_free(&ctx->arena);
+	ctx->arena = to;
+	ctx->stats.garbage_collections++;
+	return 0;
+}
 
-	// Restore and try var = False
-	memcpy(ctx->assignment->values, backup, (size_t)(num + 1) * sizeof(int));
-	ctx->assignment->values[var] = -1;
-	r = dpll_recursive_ctx(ctx);
-	if (r != 0) { free(backup); return (r == -1) ? -1 : 1; }
+static int maybe_collect_garbage(SolverCtx *ctx) {
+	if ((double)ctx->arena.wasted <= GC_WASTE_FRACTION * (double)ctx->arena.size) return 0;
+	return collect_garbage(ctx);
+}
 
-	// Restore and report UNSAT for this branch point
-	memcpy(ctx->assignment->values, backup, (size_t)(num + 1) * sizeof(int));
-	free(backup);
+// Periodic learned clause database reduction. Core clauses stay, tier2 clauses
+// unused since the last round drop to local, and the least active half of the
+// local clauses that were not used recently is deleted. Reasons are kept.
+static int reduce_db(SolverCtx *ctx) {
+	size_t count = ctx->learnts.size;
+	ReduceCandidate *cand = (ReduceCandidate *)malloc((count ? count : 1) * sizeof(ReduceCandidate));
+	if (!cand) return -1;
+	size_t nc = 0;
+	for (size_t k = 0; k < count; ++k) {
+		ClauseRef ref = ctx->learnts.data[k];
+		ArenaClause *c = clause_at(ctx, ref);
+		int tier = clause_tier(c);
+		int used = (c->flags & CLAUSE_USED) != 0;
+		c->flags &= (uint16_t)~CLAUSE_USED;
+		if (tier == TIER_CORE) continue;
+		if (tier == TIER_TIER2) {
+			if (!used) set_clause_tier(c, TIER_LOCAL);
+			continue;
+		}
+		if (used || c->size <= 2 || clause_locked(ctx, ref)) continue;
+		cand[nc].ref = ref;
+		cand[nc].lbd = c->lbd;
+		cand[nc].act = c->u.activity;
+		nc++;
+	}
+	qsort(cand, nc, sizeof(ReduceCandidate), cmp_reduce_candidate);
+	for (size_t k = 0; k < nc / 2; ++k) {
+		if (ctx->opts.proof) {
+			const ArenaClause *c = clause_at(ctx, cand[k].ref);
+			proof_delete(ctx->opts.proof, c->lits, (int)c->size, ctx->lrat ? ctx->clause_id[cand[k].ref] : 0);
+		}
+		arena_delete(&ctx->arena, cand[k].ref);
+	}
+	free(cand);
+	size_t j = 0;
+	for (size_t k = 0; k < count; ++k) {
+		ClauseRef ref = ctx->learnts.data[k];
+		if (!(clause_at(ctx, ref)->flags & ARENA_CLAUSE_DELETED)) ctx->learnts.data[j++] = ref;
+	}
+	ctx->learnts.size = j;
+	ctx->stats.deleted_clauses += nc / 2;
+	ctx->stats.reductions++;
+	clean_watches(ctx);
+	if (maybe_collect_garbage(ctx) != 0) return -1;
+	ctx->reduce_interval += (unsigned long)ctx->opts.reduce_inc;
+	ctx->next_reduce = ctx->stats.conflicts + ctx->reduce_interval;
 	return 0;
 }
 
-int dpll_solve(const CNF *cnf, Assignment *model, long timeout_ms, double *out_time_ms) {
-	if (!cnf || !model) return -2;
-	if (init_assignment(model, cnf->num_variables) != 0) return -2;
+// Element i (1-based) of the Luby sequence 1,1,2,1,1,2,4,1,1,2,...
+static unsigned long luby(unsigned long i) {
+	unsigned long size = 1, seq = 0;
+	while (size < i + 1) { seq++; size = 2 * size + 1; }
+	unsigned long x = i - 1;
+	while (size - 1 != x) {
+		size = (size - 1) >> 1;
+		seq--;
+		x = x % size;
+	}
+	return 1UL << seq;
+}
+
+// Feed a learned clause's LBD into both moving averages. The effective
+// smoothing factor starts at 1 so early samples are not biased toward zero.
+static void update_lbd_averages(SolverCtx *ctx, int lbd) {
+	ctx->lbd_samples++;
+	double a_fast = 1.0 / (double)ctx->lbd_samples;
+	double a_slow = a_fast;
+	if (a_fast < ctx->opts.restart_fast_alpha) a_fast = ctx->opts.restart_fast_alpha;
+	if (a_slow < ctx->opts.restart_slow_alpha) a_slow = ctx->opts.restart_slow_alpha;
+	ctx->lbd_fast += a_fast * ((double)lbd - ctx->lbd_fast);
+	ctx->lbd_slow += a_slow * ((double)lbd - ctx->lbd_slow);
+}
+
+static int should_restart(const SolverCtx *ctx) {
+	switch (ctx->opts.restart) {
+	case RESTART_LUBY:
+		return ctx->conflicts_since_restart >= ctx->restart_limit;
+	case RESTART_GLUCOSE:
+		// Recent conflicts produce clearly worse clauses than the long-run average
+		return ctx->conflicts_since_restart >= (unsigned long)ctx->opts.restart_min_conflicts &&
+			ctx->lbd_fast > ctx->opts.restart_margin * ctx->lbd_slow;
+	case RESTART_NONE:
+	default:
+		return 0;
+	}
+}
+
+// Return to level 0. Saved phases survive; the target phase restarts its search
+// for a longer conflict-free trail.
+static void restart(SolverCtx *ctx) {
+	cancel_until(ctx, 0);
+	ctx->stats.restarts++;
+	ctx->conflicts_since_restart = 0;
+	ctx->target_size = 0;
+	ctx->restart_limit = (unsigned long)ctx->opts.luby_unit * luby(ctx->stats.restarts + 1);
+}
+
+// Assumption 'lit' is false: collect in ctx->failed the assumptions its
+// negation was derived from (lit itself included). Every decision below the
+// assumption levels is an assumption, so the walk stops at reasonless ones.
+static void analyze_final(SolverCtx *ctx, int lit) {
+	ctx->num_failed = 0;
+	ctx->failed[ctx->num_failed++] = lit;
+	if (ctx->num_levels == 0 || ctx->level[lit_var(lit)] == 0) return;
+	ctx->seen[lit_var(lit)] = 1;
+	for (int i = ctx->trail_size - 1; i >= ctx->trail_lim[0]; --i) {
+		int v = lit_var(ctx->trail[i]);
+		if (!ctx->seen[v]) continue;
+		ctx->seen[v] = 0;
+		if (ctx->reason[v] == CLAUSE_REF_UNDEF) {
+			ctx->failed[ctx->num_failed++] = ctx->trail[i];
+			continue;
+		}
+		const ArenaClause *c = reason_at(ctx, ctx->reason[v]);
+		for (uint32_t k = 0; k < c->size; ++k) {
+			int u = lit_var(c->lits[k]);
+			if (u != v && ctx->level[u] > 0) ctx->seen[u] = 1;
+		}
+	}
+}
+
+// Add a clause learned by another portfolio thread. Called at level 0:
+// false literals are dropped, satisfied clauses skipped, units enqueued.
+// Returns 0 to go on, 1 if the clause is empty (UNSAT), -2 on error.
+static int import_clause(void *arg, const int *lits, int n, int lbd) {
+	SolverCtx *ctx = (SolverCtx *)arg;
+	int m = 0;
+	for (int i = 0; i < n; ++i) {
+		int8_t val = ctx->vals[lits[i]];
+		if (val == LIT_TRUE) {
+			ctx->stats.share_discarded++;
+			return 0;
+		}
+		if (val == LIT_UNDEF) ctx->learnt[m++] = lits[i];
+	}
+	ctx->stats.imported++;
+	if (m == 0) return 1;
+	if (m == 1) {
+		enqueue(ctx, ctx->learnt[0], CLAUSE_REF_UNDEF);
+		return 0;
+	}
+	if (lbd > m) lbd = m;
+	return add_learnt_clause(ctx, ctx->learnt, m, lbd) == CLAUSE_REF_UNDEF ? -2 : 0;
+}
+
+// Pull what the other threads shared since the last restart. Returns 1 to
+// continue the search, 0 on UNSAT, -2 on error.
+static int import_shared(SolverCtx *ctx) {
+	int r = exchange_import(ctx->opts.exchange, ctx->opts.exchange_id, import_clause, ctx,
+		&ctx->stats.share_discarded);
+	if (r == 1) return 0;
+	return r == 0 ? 1 : -2;
+}
+
+// Put the highest-level literal of lits[from..n) at position 'from'
+static void move_highest_level(SolverCtx *ctx, int *lits, int from, int n) {
+	int best = from;
+	for (int k = from + 1; k < n; ++k) {
+		if (ctx->level[lit_var(lits[k])] > ctx->level[lit_var(lits[best])]) best = k;
+	}
+	int tmp = lits[from];
+	lits[from] = lits[best];
+	lits[best] = tmp;
+}
+
+// Make a clause found by the XOR matrix the current conflict. Backjumps to
+// the clause's highest level first, since the matrix may report conflicts
+// that became false below the current level.
+static int gauss_conflict(SolverCtx *ctx, int *lits, int n) {
+	ctx->stats.gauss_conflicts++;
+	if (n == 1) {
+		// A unit implied by the XORs alone
+		cancel_until(ctx, 0);
+		if (ctx->vals[lits[0]] == LIT_FALSE) return 0;
+		if (ctx->vals[lits[0]] == LIT_UNDEF) enqueue(ctx, lits[0], CLAUSE_REF_UNDEF);
+		return 2;
+	}
+	move_highest_level(ctx, lits, 0, n);
+	cancel_until(ctx, ctx->level[lit_var(lits[0])]);
+	if (ctx->num_levels == 0) return 0;
+	ClauseRef ref = arena_alloc(&ctx->gauss_reasons, lits, (uint32_t)n);
+	if (ref == CLAUSE_REF_UNDEF || ref >= GAUSS_REASON_TAG) return -2;
+	ctx->conflict = ref | GAUSS_REASON_TAG;
+	return 0;
+}
+
+// Gauss-Jordan propagation at a unit propagation fixpoint: implied literals
+// are enqueued with their row's clause as the reason. Returns 1 at a
+// fixpoint, 2 if something was assigned, 0 on conflict, -2 on error.
+static int gauss_step(SolverCtx *ctx) {
+	GaussMatrix *g = &ctx->gauss;
+	// Tagged references need the clause arena below 2^31 words
+	if (ctx->arena.size >= GAUSS_REASON_TAG) return 1;
+	int r = gauss_propagate(g, ctx->vals, ctx->trail, ctx->trail_size);
+	if (r == GAUSS_ERROR) return -2;
+	if (r == GAUSS_NONE) return 1;
+	for (size_t at = 0; at < g->out_size;) {
+		int n = g->out[at];
+		int *lits = g->out + at + 1;
+		at += 1 + (size_t)n;
+		if ((r == GAUSS_CONFLICT && at == g->out_size) || ctx->vals[lits[0]] == LIT_FALSE) {
+			return gauss_conflict(ctx, lits, n);
+		}
+		if (ctx->vals[lits[0]] == LIT_TRUE) continue;
+		// Level-0 literals add nothing to the reason
+		int m = 1;
+		for (int k = 1; k < n; ++k) {
+			if (ctx->level[lit_var(lits[k])] > 0) lits[m++] = lits[k];
+		}
+		ctx->stats.gauss_propagations++;
+		if (m == 1) {
+			cancel_until(ctx, 0);
+			enqueue(ctx, lits[0], CLAUSE_REF_UNDEF);
+			return 2;
+		}
+		ClauseRef ref = arena_alloc(&ctx->gauss_reasons, lits, (uint32_t)m);
+		if (ref == CLAUSE_REF_UNDEF || ref >= GAUSS_REASON_TAG) return -2;
+		enqueue(ctx, lits[0], ref | GAUSS_REASON_TAG);
+	}
+	return 2;
+}
+
+// Extract XORs from the original clauses and build the matrix.
+// Returns 1 if ready (possibly without any XOR), 0 if they are inconsistent, -2 on error.
+static int init_gauss(SolverCtx *ctx) {
+	XorList xors;
+	if (xor_detect(&ctx->arena, ctx->originals.data, ctx->originals.size, &xors) < 0) return -2;
+	int r = gauss_init(&ctx->gauss, ctx->num_vars, &xors);
+	xor_list_free(&xors);
+	if (r < 0) return -2;
+	ctx->stats.xor_constraints = ctx->gauss.num_rows;
+	if (r == 1 && ctx->gauss.num_rows) {
+		ctx->gauss_lim = (uint32_t *)calloc((size_t)MAX_LEVELS(ctx->num_vars), sizeof(uint32_t));
+		if (!ctx->gauss_lim || arena_init(&ctx->gauss_reasons, 1024) != 0) return -2;
+	}
+	return r;
+}
+
+// Conflict-driven clause learning search with non-chronological backjumping.
+static int cdcl_search(SolverCtx *ctx) {
+	ctx->restart_limit = (unsigned long)ctx->opts.luby_unit * luby(1);
+	for (;;) {
+		int p = unit_propagate(ctx);
+		if (p == 1 && ctx->gauss.num_rows) {
+			p = gauss_step(ctx);
+			if (p == 2) continue;
+		}
+		if (p == -2) return -2;
+		if (p == 1 && ctx->lrat && ctx->num_levels == 0) lrat_level0_units(ctx);
+		if (p == 0) {
+			if (ctx->num_levels == 0) {
+				if (ctx->opts.proof) log_empty(ctx);
+				return 0;
+			}
+			if ((++ctx->stats.conflicts & 255) == 0 && timed_out(ctx)) return -1;
+			update_target_phase(ctx);
+			int bt = 0;
+			int n = analyze(ctx, &bt);
+			uint64_t id = ctx->opts.proof ? log_learnt(ctx, n) : 0;
+			int lbd = compute_lbd(ctx, ctx->learnt, n);
+			if (ctx->opts.exchange &&
+				exchange_export(ctx->opts.exchange, ctx->opts.exchange_id, ctx->learnt, n, lbd)) {
+				ctx->stats.exported++;
+			}
+			update_lbd_averages(ctx, lbd);
+			ctx->conflicts_since_restart++;
+			decay_var_activity(ctx);
+			ctx->cla_inc /= (float)ctx->opts.clause_decay;
+			cancel_until(ctx, bt);
+			if (n == 1) {
+				enqueue(ctx, ctx->learnt[0], CLAUSE_REF_UNDEF);
+				if (ctx->lrat) ctx->unit_id[lit_var(ctx->learnt[0])] = id;
+			} else {
+				ClauseRef ref = add_learnt_clause(ctx, ctx->learnt, n, lbd);
+				if (ref == CLAUSE_REF_UNDEF || (ctx->lrat && set_clause_id(ctx, ref, id) != 0)) return -2;
+				bump_clause(ctx, clause_at(ctx, ref));
+				enqueue(ctx, ctx->learnt[0], ref);
+			}
+			continue;
+		}
+		if (ctx->stats.conflicts >= ctx->next_reduce && reduce_db(ctx) != 0) return -2;
+		if (should_restart(ctx)) {
+			restart(ctx);
+			if (ctx->opts.exchange) {
+				int s = import_shared(ctx);
+				if (s != 1) return s;
+			}
+			continue;
+		}
+		// Assumptions first, one level each
+		int next = -1;
+		while (ctx->num_levels < ctx->num_assumptions) {
+			int a = ctx->assumptions[ctx->num_levels];
+			if (ctx->vals[a] == LIT_TRUE) {
+				new_level(ctx, 0);
+			} else if (ctx->vals[a] == LIT_FALSE) {
+				analyze_final(ctx, a);
+				return 0;
+			} else {
+				next = a;
+				break;
+			}
+		}
+		if (next == -1) {
+			int var = choose_branch_variable(ctx);
+			if (var == -1) return 1;
+			next = choose_polarity(ctx, var);
+		}
+		ctx->stats.decisions++;
+		new_decision(ctx, next, 0);
+	}
+}
+
+typedef int (*SearchFn)(SolverCtx *ctx);
+
+void solver_default_options(SolverOptions *opts) {
+	if (!opts) return;
+	opts->decision = DECIDE_VSIDS;
+	opts->var_decay = 0.95;
+	opts->phase = PHASE_SAVED;
+	opts->initial_phase = -1;
+	opts->seed = 0;
+	opts->restart = RESTART_GLUCOSE;
+	opts->luby_unit = 100;
+	opts->restart_fast_alpha = 0.03;
+	opts->restart_slow_alpha = 1e-5;
+	opts->restart_margin = 1.10;
+	opts->restart_min_conflicts = 2;
+	opts->core_lbd = 2;
+	opts->tier2_lbd = 6;
+	opts->reduce_first = 2000;
+	opts->reduce_inc = 300;
+	opts->clause_decay = 0.999;
+	opts->gauss = 1;
+	opts->shuffle_order = 0;
+	opts->stop = NULL;
+	opts->exchange = NULL;
+	opts->exchange_id = 0;
+	opts->proof = NULL;
+}
+
+// Build the solver state from at most one of 'cnf' (copied clause by clause)
+// or 'ocnf' (its arena is copied in one block); with neither the formula is
+// empty. Returns 1 if ready, 0 if the formula is trivially UNSAT, -2 on
+// error; ctx must be freed either way.
+static int setup_ctx(SolverCtx *ctx, const CNF *cnf, const OptCNF *ocnf, const SolverOptions *opts, int gauss) {
+	int nv = cnf ? cnf->num_variables : ocnf ? ocnf->num_variables : 0;
+	memset(ctx, 0, sizeof(*ctx));
+	if (opts) ctx->opts = *opts;
+	else solver_default_options(&ctx->opts);
+	if (ctx->opts.var_decay <= 0.0 || ctx->opts.var_decay >= 1.0) ctx->opts.var_decay = 0.95;
+	if (ctx->opts.luby_unit <= 0) ctx->opts.luby_unit = 100;
+	if (ctx->opts.reduce_first <= 0) ctx->opts.reduce_first = 2000;
+	if (ctx->opts.clause_decay <= 0.0 || ctx->opts.clause_decay >= 1.0) ctx->opts.clause_decay = 0.999;
+	if (ctx->opts.proof) {
+		// XOR reasoning and imported clauses cannot be justified clause by clause
+		ctx->opts.gauss = 0;
+		ctx->opts.exchange = NULL;
+		ctx->lrat = proof_format(ctx->opts.proof) == PROOF_LRAT;
+	}
+	ctx->start_ms = wall_ms();
+	int r = init_ctx(ctx, nv) == 0 ? 1 : -2;
+	if (r == 1 && ctx->lrat) {
+		ctx->unit_id = (uint64_t *)calloc((size_t)nv + 1, sizeof(uint64_t));
+		ctx->hints = (uint64_t *)malloc((2 * (size_t)nv + 3) * sizeof(uint64_t));
+		ctx->hint_pos = (int *)malloc(((size_t)nv + 1) * sizeof(int));
+		if (!ctx->unit_id || !ctx->hints || !ctx->hint_pos) r = -2;
+	}
+	if (r == 1) {
+		if (cnf) {
+			RefVec refs = {0};
+			r = load_cnf(ctx, cnf, &refs) == 0 ? attach_originals(ctx, refs.data, refs.size) : -2;
+			free(refs.data);
+		} else if (!ocnf) {
+			r = arena_init(&ctx->arena, 1024) == 0 ? 1 : -2;
+		} else {
+			r = arena_copy(&ctx->arena, &ocnf->arena) == 0 ? attach_originals(ctx, ocnf->clauses, ocnf->num_clauses) : -2;
+		}
+	}
+	if (r == 1 && gauss && ctx->opts.gauss) r = init_gauss(ctx);
+	return r;
+}
+
+// Back to DIMACS polarity per variable at the API boundary
+static void extract_model(const SolverCtx *ctx, Assignment *model) {
+	for (int v = 1; v <= ctx->num_vars; ++v) model->values[v] = ctx->vals[mk_lit(v, 0)];
+}
+
+// One-shot solve: build the state, run 'search' and tear it down again
+static int run_solver(const CNF *cnf, const OptCNF *ocnf, Assignment *model, const SolverOptions *opts,
+	SolverStats *stats, long timeout_ms, double *out_time_ms, SearchFn search) {
+	if ((!cnf && !ocnf) || !model) return -2;
+	int nv = cnf ? cnf->num_variables : ocnf->num_variables;
+	if (init_assignment(model, nv) != 0) return -2;
 	SolverCtx ctx;
-	ctx.cnf = cnf;
+	int r = setup_ctx(&ctx, cnf, ocnf, opts, search == cdcl_search);
 	ctx.assignment = model;
 	ctx.timeout_ms = timeout_ms;
-	ctx.start_clock = clock();
-	int r = dpll_recursive_ctx(&ctx);
-	clock_t end_clock = clock();
-	double ms = (double)(end_clock - ctx.start_clock) * 1000.0 / (double)CLOCKS_PER_SEC;
+	if (r == 1) r = search(&ctx);
+	if (r == 1) extract_model(&ctx, model);
+	ctx.stats.learned_clauses = ctx.learnts.size;
+	free_ctx(&ctx);
+	double ms = wall_ms() - ctx.start_ms;
 	if (out_time_ms) *out_time_ms = ms;
+	if (stats) *stats = ctx.stats;
 	if (r == 1) return 1;
-	if (r == -1) { free_assignment(model); return -1; }
 	free_assignment(model);
+	if (r == -1) return -1;
+	if (r == -2) return -2;
+	return 0;
+}
+
+int dpll_solve(const CNF *cnf, Assignment *model, long timeout_ms, double *out_time_ms) {
+	if (!cnf) return -2;
+	return run_solver(cnf, NULL, model, NULL, NULL, timeout_ms, out_time_ms, dpll_search);
+}
+
+int cdcl_solve(const CNF *cnf, Assignment *model, long timeout_ms, double *out_time_ms) {
+	if (!cnf) return -2;
+	return run_solver(cnf, NULL, model, NULL, NULL, timeout_ms, out_time_ms, cdcl_search);
+}
+
+int dpll_solve_opt(const OptCNF *cnf, Assignment *model, long timeout_ms, double *out_time_ms) {
+	if (!cnf) return -2;
+	return run_solver(NULL, cnf, model, NULL, NULL, timeout_ms, out_time_ms, dpll_search);
+}
+
+int cdcl_solve_opt(const OptCNF *cnf, Assignment *model, const SolverOptions *opts, SolverStats *stats,
+	long timeout_ms, double *out_time_ms) {
+	if (!cnf) return -2;
+	return run_solver(NULL, cnf, model, opts, stats, timeout_ms, out_time_ms, cdcl_search);
+}
+
+struct Solver {
+	SolverCtx ctx;
+	int status;         // 1 usable, 0 the formula is UNSAT, -2 broken by an earlier error
+	int has_model;      // vals still hold the model of the last SAT answer
+	int gauss_built;    // XORs are looked for once, at the first solve
+	int *occ;           // lookahead: weighted occurrences per variable, built on first use
+};
+
+// Both constructors: 'cnf' may be NULL for an empty formula
+static Solver *new_solver(const OptCNF *cnf, const SolverOptions *opts) {
+	Solver *s = (Solver *)calloc(1, sizeof(Solver));
+	if (!s) return NULL;
+	// Proofs cover one-shot solves: clauses added later are not in the input
+	SolverOptions o;
+	if (opts) o = *opts;
+	else solver_default_options(&o);
+	o.proof = NULL;
+	s->status = setup_ctx(&s->ctx, NULL, cnf, &o, 0);
+	int nv = s->ctx.num_vars;
+	s->ctx.failed = (int *)malloc((size_t)(nv + 2) * sizeof(int));
+	if (s->status == -2 || !s->ctx.failed) {
+		solver_free(s);
+		return NULL;
+	}
+	return s;
+}
+
+Solver *solver_new(const SolverOptions *opts) {
+	return new_solver(NULL, opts);
+}
+
+Solver *solver_new_opt(const OptCNF *cnf, const SolverOptions *opts) {
+	return cnf ? new_solver(cnf, opts) : NULL;
+}
+
+int solver_num_vars(const Solver *s) {
+	return s ? s->ctx.num_vars : 0;
+}
+
+int solver_add_clause(Solver *s, const int *lits, int n) {
+	if (!s || n < 0 || (n > 0 && !lits) || s->status == -2) return -1;
+	SolverCtx *ctx = &s->ctx;
+	int max_var = 0;
+	for (int i = 0; i < n; ++i) {
+		int v = lits[i] > 0 ? lits[i] : -lits[i];
+		if (v == 0 || lits[i] == INT_MIN) return -1;
+		if (v > max_var) max_var = v;
+	}
+	if (max_var > ctx->num_vars && grow_vars(ctx, max_var) != 0) {
+		s->status = -2;
+		return -1;
+	}
+	s->has_model = 0;
+	if (s->status == 0) return 0;
+	cancel_until(ctx, 0);
+	// Same normalization as attach_originals, against the level-0 values:
+	// duplicates, tautologies and satisfied clauses go, false literals too
+	unsigned char *mark = ctx->seen;
+	int m = 0, drop = 0;
+	for (int i = 0; i < n && !drop; ++i) {
+		int lit = lit_from_dimacs(lits[i]);
+		int v = lit_var(lit);
+		unsigned char mk = lit_neg(lit) ? 2 : 1;
+		if (mark[v] == mk) continue;
+		if (mark[v]) drop = 1;
+		mark[v] = mk;
+		ctx->learnt[m++] = lit;
+	}
+	for (int k = 0; k < m; ++k) mark[lit_var(ctx->learnt[k])] = 0;
+	if (drop) return 0;
+	int kept = 0;
+	for (int k = 0; k < m; ++k) {
+		int8_t val = ctx->vals[ctx->learnt[k]];
+		if (val == LIT_TRUE) return 0;
+		if (val == LIT_UNDEF) ctx->learnt[kept++] = ctx->learnt[k];
+	}
+	if (kept == 0) {
+		s->status = 0;
+		return 0;
+	}
+	if (kept == 1) {
+		enqueue(ctx, ctx->learnt[0], CLAUSE_REF_UNDEF);
+		return 0;
+	}
+	ClauseRef ref = arena_alloc(&ctx->arena, ctx->learnt, (uint32_t)kept);
+	if (ref != CLAUSE_REF_UNDEF) clause_at(ctx, ref)->flags = 0;
+	if (ref == CLAUSE_REF_UNDEF || refvec_push(&ctx->originals, ref) != 0 || attach_clause(ctx, ref) != 0) {
+		s->status = -2;
+		return -1;
+	}
+	return 0;
+}
+
+int solver_value(const Solver *s, int lit) {
+	if (!s || !s->has_model || lit == 0 || lit == INT_MIN) return 0;
+	int v = lit > 0 ? lit : -lit;
+	if (v > s->ctx.num_vars) return 0;
+	return s->ctx.vals[lit_from_dimacs(lit)];
+}
+
+void solver_free(Solver *s) {
+	if (!s) return;
+	free_ctx(&s->ctx);
+	free(s->occ);
+	free(s);
+}
+
+// Take the DIMACS assumptions into ctx->assumptions, creating variables no
+// clause has mentioned yet. Repeated literals are kept once, so every
+// assumption level has its own variable and MAX_LEVELS still holds; both
+// polarities of a variable stay and end the search UNSAT. Returns 0, -1 on
+// a zero literal (nothing changed), -2 on allocation failure.
+static int set_assumptions(SolverCtx *ctx, const int *lits, int n) {
+	int max_var = 0;
+	for (int i = 0; i < n; ++i) {
+		if (lits[i] == 0 || lits[i] == INT_MIN) return -1;
+		int v = lits[i] > 0 ? lits[i] : -lits[i];
+		if (v > max_var) max_var = v;
+	}
+	if (max_var > ctx->num_vars && grow_vars(ctx, max_var) != 0) return -2;
+	if (n > ctx->assumptions_cap) {
+		int *a = (int *)realloc(ctx->assumptions, (size_t)n * sizeof(int));
+		if (!a) return -2;
+		ctx->assumptions = a;
+		ctx->assumptions_cap = n;
+	}
+	unsigned char *mark = ctx->seen;
+	int m = 0;
+	for (int i = 0; i < n; ++i) {
+		int lit = lit_from_dimacs(lits[i]);
+		unsigned char mk = lit_neg(lit) ? 2 : 1;
+		if (mark[lit_var(lit)] & mk) continue;
+		mark[lit_var(lit)] |= mk;
+		ctx->assumptions[m++] = lit;
+	}
+	for (int k = 0; k < m; ++k) mark[lit_var(ctx->assumptions[k])] = 0;
+	ctx->num_assumptions = m;
+	return 0;
+}
+
+int solver_solve(Solver *s, const int *assumptions, int num_assumptions, Assignment *model, long timeout_ms,
+	double *out_time_ms) {
+	if (!s || num_assumptions < 0 || (num_assumptions > 0 && !assumptions)) return -2;
+	SolverCtx *ctx = &s->ctx;
+	ctx->start_ms = wall_ms();
+	ctx->timeout_ms = timeout_ms;
+	ctx->num_failed = 0;
+	s->has_model = 0;
+	// Variables are created even when the formula is already UNSAT, as in solver_add_clause
+	if (s->status != -2) {
+		int a = set_assumptions(ctx, assumptions, num_assumptions);
+		if (a == -2) s->status = -2;
+		if (a != 0) {
+			ctx->num_assumptions = 0;
+			return -2;
+		}
+	}
+	int r = s->status;
+	if (r == 1) {
+		// Learned clauses, activities and phases carry over from the last call
+		cancel_until(ctx, 0);
+		if (!s->gauss_built) {
+			s->gauss_built = 1;
+			if (ctx->opts.gauss) r = init_gauss(ctx);
+		}
+		if (r == 1) r = cdcl_search(ctx);
+		if (r == 0 && ctx->num_failed == 0) s->status = 0;
+		if (r == -2) s->status = -2;
+	}
+	ctx->num_assumptions = 0;
+	if (r == 1) {
+		s->has_model = 1;
+		// The model stays readable through solver_value until the next change
+		if (model && init_assignment(model, ctx->num_vars) != 0) r = -2;
+		else if (model) extract_model(ctx, model);
+	}
+	ctx->stats.learned_clauses = ctx->learnts.size;
+	if (out_time_ms) *out_time_ms = wall_ms() - ctx->start_ms;
+	return r;
+}
+
+int solver_failed_assumptions(const Solver *s, int *lits) {
+	if (!s) return 0;
+	for (int i = 0; lits && i < s->ctx.num_failed; ++i) lits[i] = lit_to_dimacs(s->ctx.failed[i]);
+	return s->ctx.num_failed;
+}
+
+void solver_get_stats(const Solver *s, SolverStats *stats) {
+	if (s && stats) *stats = s->ctx.stats;
+}
+
+// Lookahead preselection: occurrences in the original clauses, binaries twice
+static int build_occurrences(Solver *s) {
+	SolverCtx *ctx = &s->ctx;
+	s->occ = (int *)calloc((size_t)(ctx->num_vars + 1), sizeof(int));
+	if (!s->occ) return -1;
+	for (size_t i = 0; i < ctx->originals.size; ++i) {
+		const ArenaClause *c = clause_at(ctx, ctx->originals.data[i]);
+		int w = c->size == 2 ? 2 : 1;
+		for (uint32_t k = 0; k < c->size; ++k) s->occ[lit_var(c->lits[k])] += w;
+	}
 	return 0;
 }
 
+typedef struct LookCandidate {
+	int occ;
+	int var;
+} LookCandidate;
+
+static int cmp_look_candidate(const void *a, const void *b) {
+	const LookCandidate *x = (const LookCandidate *)a, *y = (const LookCandidate *)b;
+	if (x->occ != y->occ) return x->occ > y->occ ? -1 : 1;
+	return x->var - y->var;
+}
+
+// Assign 'lit' on a new level and propagate. Returns the number of literals
+// it implied, -1 on conflict (the level is then removed again), -2 on error.
+static int look_assign(SolverCtx *ctx, int lit) {
+	int base = ctx->trail_size;
+	new_decision(ctx, lit, 0);
+	int p = unit_propagate(ctx);
+	if (p == -2) return -2;
+	if (p == 0) {
+		cancel_until(ctx, ctx->num_levels - 1);
+		return -1;
+	}
+	return ctx->trail_size - base;
+}
+
+int solver_lookahead(Solver *s, const int *cube, int n, int max_candidates, int *implied, int *num_implied,
+	int *branch_var) {
+	if (!s || (n > 0 && !cube) || !implied || !num_implied || !branch_var) return -2;
+	*num_implied = 0;
+	*branch_var = 0;
+	if (s->status != 1) return s->status;
+	SolverCtx *ctx = &s->ctx;
+	if (!s->occ && build_occurrences(s) != 0) return -2;
+	s->has_model = 0;
+	cancel_until(ctx, 0);
+	int p = unit_propagate(ctx);
+	if (p != 1) {
+		if (p == 0) s->status = 0;
+		return p;
+	}
+	int r = 1;
+	for (int i = 0; i < n && r == 1; ++i) {
+		int v = cube[i] > 0 ? cube[i] : -cube[i];
+		if (v < 1 || v > ctx->num_vars) r = -2;
+		else if (ctx->vals[lit_from_dimacs(cube[i])] == LIT_FALSE) r = 0;
+		else if (ctx->vals[lit_from_dimacs(cube[i])] == LIT_UNDEF) {
+			int k = look_assign(ctx, lit_from_dimacs(cube[i]));
+			if (k < 0) r = k == -1 ? 0 : -2;
+		}
+	}
+	LookCandidate *cand = NULL;
+	if (r == 1) {
+		cand = (LookCandidate *)malloc((size_t)(ctx->num_vars + 1) * sizeof(LookCandidate));
+		if (!cand) r = -2;
+	}
+	// Score both polarities of the most frequent free variables by the
+	// literals they imply (product, as in march); a failed polarity fixes
+	// the other one and the selection starts over
+	while (r == 1) {
+		int m = 0;
+		for (int v = 1; v <= ctx->num_vars; ++v) {
+			if (ctx->vals[mk_lit(v, 0)] == LIT_UNDEF && s->occ[v] > 0) {
+				cand[m].occ = s->occ[v];
+				cand[m++].var = v;
+			}
+		}
+		qsort(cand, (size_t)m, sizeof(LookCandidate), cmp_look_candidate);
+		if (max_candidates > 0 && m > max_candidates) m = max_candidates;
+		double best = -1.0;
+		int forced = 0;
+		*branch_var = 0;
+		for (int i = 0; i < m && !forced && r == 1; ++i) {
+			int v = cand[i].var;
+			if (ctx->vals[mk_lit(v, 0)] != LIT_UNDEF) continue;
+			int pos = look_assign(ctx, mk_lit(v, 0));
+			if (pos >= 0) cancel_until(ctx, ctx->num_levels - 1);
+			int neg = pos == -2 ? -2 : look_assign(ctx, mk_lit(v, 1));
+			if (neg >= 0) cancel_until(ctx, ctx->num_levels - 1);
+			if (pos == -2 || neg == -2) { r = -2; break; }
+			if (pos == -1 && neg == -1) { r = 0; break; }
+			if (pos == -1 || neg == -1) {
+				int lit = mk_lit(v, pos == -1);
+				implied[(*num_implied)++] = lit_to_dimacs(lit);
+				int k = look_assign(ctx, lit);
+				if (k < 0) r = k == -1 ? 0 : -2;
+				forced = 1;
+				continue;
+			}
+			double score = (double)pos * (double)neg + (double)pos + (double)neg;
+			if (score > best) {
+				best = score;
+				*branch_var = v;
+			}
+		}
+		if (!forced) break;
+	}
+	free(cand);
+	cancel_until(ctx, 0);
+	return r;
+}
+
 int verify_model_satisfies(const CNF *cnf, const Assignment *model) {
 	if (!cnf || !model || !model->values) return -1;
 	for (size_t i = 0; i < cnf->num_clauses; ++i) {
@@ -165,4 +1878,20 @@ int verify_model_satisfies(const CNF *cnf, const Assignment *model) {
 	return 1;
 }
 
+int verify_model_satisfies_opt(const OptCNF *cnf, const Assignment *model) {
+	if (!cnf || !model || !model->values) return -1;
+	for (size_t i = 0; i < cnf->num_clauses; ++i) {
+		const ArenaClause *cl = arena_clause(&cnf->arena, cnf->clauses[i]);
+		int sat = 0;
+		for (uint32_t j = 0; j < cl->size; ++j) {
+			int lit = cl->lits[j];
+			int var = lit > 0 ? lit : -lit;
+			if (var < 1 || var > model->num_variables) return -1;
+			int val = model->values[var];
+			if ((lit > 0 && val == 1) || (lit < 0 && val == -1)) { sat = 1; break; }
+		}
+		if (!sat) return 0;
+	}
+	return 1;
+}
 
@@ -1,10 +1,14 @@
-// solver.h - DPLL SAT solver interface
+// solver.h - DPLL/CDCL SAT solver interface
 #ifndef SAT_SOLVER_H
 #define SAT_SOLVER_H
 
 #include "parser.h"
+#include "parser_opt.h"
 #include <stddef.h>
 
+struct ClauseExchange;
+struct ProofWriter;
+
 typedef struct Assignment {
 	// assignment for variables 1..num_variables
 	// values: -1 = false, 0 = unassigned, 1 = true
@@ -12,7 +16,76 @@ typedef struct Assignment {
 	int num_variables;
 } Assignment;
 
-// Initialize assignment with all variables unassigned
+// Branching variable selection for the CDCL search
+typedef enum DecisionHeuristic {
+	DECIDE_VSIDS = 0,   // exponential VSIDS activities kept in a binary heap
+	DECIDE_STATIC = 1   // lowest-numbered unassigned variable
+} DecisionHeuristic;
+
+// Polarity of a decision literal
+typedef enum PhasePolicy {
+	PHASE_SAVED = 0,    // last value the variable had (phase saving)
+	PHASE_FALSE = 1,
+	PHASE_TRUE = 2,
+	PHASE_RANDOM = 3,
+	PHASE_TARGET = 4,   // value on the longest conflict-free trail, else saved
+	PHASE_BEST = 5      // value on the longest trail ever reached, else saved
+} PhasePolicy;
+
+// When to abandon the current trail and restart from level 0
+typedef enum RestartPolicy {
+	RESTART_GLUCOSE = 0, // fast EMA of learned-clause LBD exceeds margin * slow EMA
+	RESTART_LUBY = 1,    // luby_unit * Luby(i) conflicts between restarts
+	RESTART_NONE = 2
+} RestartPolicy;
+
+typedef struct SolverOptions {
+	DecisionHeuristic decision;
+	double var_decay;   // VSIDS activity decay per conflict, in (0, 1)
+	PhasePolicy phase;
+	int initial_phase;  // saved phase before a variable is first assigned: 1 or -1
+	unsigned long long seed; // random phase seed, 0 = fixed default
+	RestartPolicy restart;
+	int luby_unit;      // conflicts per Luby unit
+	double restart_fast_alpha;  // smoothing of the short-horizon LBD average
+	double restart_slow_alpha;  // smoothing of the long-horizon LBD average
+	double restart_margin;      // glucose restart when fast > margin * slow
+	int restart_min_conflicts;  // minimum conflicts between glucose restarts
+	int core_lbd;       // learned clauses with LBD <= core_lbd are never deleted
+	int tier2_lbd;      // LBD <= tier2_lbd survives reductions while still used
+	int reduce_first;   // conflicts before the first clause database reduction
+	int reduce_inc;     // growth of the reduction interval after each round
+	double clause_decay; // learned clause activity decay per conflict, in (0, 1)
+	int gauss;          // detect XOR constraints and propagate them by Gauss-Jordan elimination
+	int shuffle_order;  // start VSIDS from a seeded random variable order instead of index order
+	volatile int *stop; // the search gives up (as on timeout) once *stop is non-zero; NULL = never
+	struct ClauseExchange *exchange; // portfolio clause sharing, NULL = off
+	int exchange_id;    // this thread's ring in 'exchange'
+	struct ProofWriter *proof; // DRAT/LRAT log of one-shot solves, NULL = off; disables gauss and exchange
+} SolverOptions;
+
+typedef struct SolverStats {
+	unsigned long decisions;
+	unsigned long conflicts;
+	unsigned long propagations; // literals taken off the propagation queue
+	unsigned long restarts;
+	unsigned long reductions;       // learned clause database reductions
+	unsigned long deleted_clauses;  // learned clauses removed by reductions
+	size_t learned_clauses;         // learned clauses held when the search ended
+	unsigned long garbage_collections; // clause arena compactions
+	int xor_constraints;            // rows of the Gauss-Jordan matrix
+	unsigned long gauss_propagations;
+	unsigned long gauss_conflicts;
+	unsigned long exported;         // learned clauses offered to other portfolio threads
+	unsigned long imported;         // clauses of other threads added at restarts
+	unsigned long share_discarded;  // shared clauses satisfied at level 0 or overwritten unread
+} SolverStats;
+
+// Fill 'opts' with the defaults used by cdcl_solve
+void solver_default_options(SolverOptions *opts);
+
+// Initialize assignment with all variables unassigned; num_variables may be
+// 0 (the model of an empty formula)
 int init_assignment(Assignment *a, int num_variables);
 void free_assignment(Assignment *a);
 
@@ -23,9 +96,70 @@ void free_assignment(Assignment *a);
 // If out_time_ms is not NULL, writes measured solver time in milliseconds.
 int dpll_solve(const CNF *cnf, Assignment *model, long timeout_ms, double *out_time_ms);
 
+// Conflict-driven clause learning solver: first-UIP learning with clause
+// minimization and non-chronological backjumping. Same contract as dpll_solve.
+int cdcl_solve(const CNF *cnf, Assignment *model, long timeout_ms, double *out_time_ms);
+
+// Solvers working directly on the parser's clause arena (copied in one block,
+// no per-clause conversion). cdcl_solve_opt takes explicit options (NULL =
+// defaults); if stats is not NULL it receives the search counters, also on
+// UNSAT and timeout.
+int dpll_solve_opt(const OptCNF *cnf, Assignment *model, long timeout_ms, double *out_time_ms);
+int cdcl_solve_opt(const OptCNF *cnf, Assignment *model, const SolverOptions *opts, SolverStats *stats,
+	long timeout_ms, double *out_time_ms);
+
+// Incremental CDCL instance: start empty (solver_new) or from a copy of a
+// formula (solver_new_opt), add clauses and solve any number of times under
+// different assumptions; learned clauses, activities and phases carry over
+// between calls. Both return NULL on allocation failure; opts may be NULL.
+// XOR constraints are extracted at the first solve only.
+typedef struct Solver Solver;
+Solver *solver_new(const SolverOptions *opts);
+Solver *solver_new_opt(const OptCNF *cnf, const SolverOptions *opts);
+void solver_free(Solver *s);
+
+// Add a clause of n DIMACS literals (no terminating 0); variables are
+// created as clauses mention them. Returns 0, or -1 on a zero literal or
+// allocation failure. A clause that makes the formula UNSAT is accepted:
+// the next solve returns 0.
+int solver_add_clause(Solver *s, const int *lits, int n);
+
+// Highest variable seen so far
+int solver_num_vars(const Solver *s);
+
+// Solve with the DIMACS literals 'assumptions' held true. Same contract as
+// cdcl_solve_opt, except that 'model' may be NULL (see solver_value);
+// 0 means UNSAT under the assumptions, see solver_failed_assumptions.
+// Assumptions may repeat, contradict each other or name variables no clause
+// has mentioned yet (they are created like in solver_add_clause).
+int solver_solve(Solver *s, const int *assumptions, int num_assumptions, Assignment *model, long timeout_ms,
+	double *out_time_ms);
+
+// Value of a DIMACS literal in the model of the last solve: 1 true,
+// -1 false, 0 if there is no model (not SAT, or clauses added since).
+int solver_value(const Solver *s, int lit);
+
+// After solver_solve returned 0: the assumptions (DIMACS) that together
+// contradict the formula, written to 'lits' (room for num_assumptions + 1)
+// if not NULL. Returns their number; 0 means the formula itself is UNSAT.
+int solver_failed_assumptions(const Solver *s, int *lits);
+
+// Counters accumulated over all calls
+void solver_get_stats(const Solver *s, SolverStats *stats);
+
+// One lookahead step for cube splitting: assign 'cube' (DIMACS), propagate,
+// then try both polarities of up to max_candidates free variables (0 = all),
+// the most frequent first. Literals whose negation fails are appended to
+// 'implied' (room for num_variables). Returns 1 with *branch_var the
+// variable whose two branches imply the most (0 if every candidate is
+// assigned), 0 if the cube is refuted, -2 on error.
+int solver_lookahead(Solver *s, const int *cube, int n, int max_candidates, int *implied, int *num_implied,
+	int *branch_var);
+
 // Verify that the given assignment satisfies the CNF.
 // Returns 1 if satisfied, 0 if any clause is unsatisfied, -1 on error.
 int verify_model_satisfies(const CNF *cnf, const Assignment *model);
+int verify_model_satisfies_opt(const OptCNF *cnf, const Assignment *model);
 
 #endif // SAT_SOLVER_H
 
@@ -1,4 +1,5 @@
 #include "sudoku.h"
+#include "out_buffer.h"
 
 // Initialize Sudoku grid
 static void init_sudoku_grid(Sudoku* sudoku) {
@@ -65,47 +66,11 @@ OptCNF* sudoku_to_cnf(Sudoku* sudoku) {
     // 数独有9*9*9 = 729个变量
     // 变量 x_{i,j,k} 表示位置(i,j)填入数字k
     // 编码：(i-1)*81 + (j-1)*9 + k
-    cnf->num_variables = SUDOKU_SIZE * SUDOKU_SIZE * SUDOKU_SIZE;
-    cnf->num_clauses = 0;
-    cnf->clauses = NULL;
-    cnf->literals_pool = NULL;
-    cnf->pool_len = 0;
-    
-    // Pre-allocate memory pools
-    size_t pool_capacity = 10000;
-    size_t clauses_capacity = 2000;
-    
-    cnf->literals_pool = (int*)malloc(pool_capacity * sizeof(int));
-    cnf->clauses = (OptClause*)malloc(clauses_capacity * sizeof(OptClause));
-    if (!cnf->literals_pool || !cnf->clauses) {
-        free(cnf->literals_pool);
-        free(cnf->clauses);
+    if (opt_cnf_init(cnf, SUDOKU_SIZE * SUDOKU_SIZE * SUDOKU_SIZE) != 0) {
         free(cnf);
         return NULL;
     }
     
-    // 辅助函数：添加子句
-    auto void add_clause(int* literals, int size) {
-        if (cnf->num_clauses >= clauses_capacity) {
-            clauses_capacity *= 2;
-            cnf->clauses = realloc(cnf->clauses, clauses_capacity * sizeof(OptClause));
-        }
-        
-        if (cnf->pool_len + size > pool_capacity) {
-            pool_capacity = (cnf->pool_len + size) * 2;
-            cnf->literals_pool = realloc(cnf->literals_pool, pool_capacity * sizeof(int));
-        }
-        
-        OptClause* clause = &cnf->clauses[cnf->num_clauses];
-        clause->start_index = cnf->pool_len;
-        clause->num_literals = size;
-        
-        for (int i = 0; i < size; i++) {
-            cnf->literals_pool[cnf->pool_len++] = literals[i];
-        }
-        cnf->num_clauses++;
-    }
-    
     // Helper macro for variable encoding
     #define VAR_ID(i, j, k) ((i-1)*81 + (j-1)*9 + k)
     
@@ -117,7 +82,7 @@ OptCNF* sudoku_to_cnf(Sudoku* sudoku) {
             for (int k = 1; k <= SUDOKU_SIZE; k++) {
                 temp_literals[k-1] = VAR_ID(i, j, k);
             }
-            add_clause(temp_literals, SUDOKU_SIZE);
+            opt_cnf_add_clause(cnf, temp_literals, SUDOKU_SIZE);
         }
     }
     
@@ -128,7 +93,7 @@ OptCNF* sudoku_to_cnf(Sudoku* sudoku) {
                 for (int k2 = k1 + 1; k2 <= SUDOKU_SIZE; k2++) {
                     temp_literals[0] = -VAR_ID(i, j, k1);
                     temp_literals[1] = -VAR_ID(i, j, k2);
-                    add_clause(temp_literals, 2);
+                    opt_cnf_add_clause(cnf, temp_literals, 2);
                 }
             }
         }
@@ -141,14 +106,14 @@ OptCNF* sudoku_to_cnf(Sudoku* sudoku) {
             for (int j = 1; j <= SUDOKU_SIZE; j++) {
                 temp_literals[j-1] = (i-1)*81 + (j-1)*9 + k;
             }
-            add_clause(temp_literals, SUDOKU_SIZE);
+            opt_cnf_add_clause(cnf, temp_literals, SUDOKU_SIZE);
             
             // 最多一次
             for (int j1 = 1; j1 <= SUDOKU_SIZE; j1++) {
                 for (int j2 = j1 + 1; j2 <= SUDOKU_SIZE; j2++) {
                     temp_literals[0] = -((i-1)*81 + (j1-1)*9 + k);
                     temp_literals[1] = -((i-1)*81 + (j2-1)*9 + k);
-                    add_clause(temp_literals, 2);
+                    opt_cnf_add_clause(cnf, temp_literals, 2);
                 }
             }
         }
@@ -161,14 +126,14 @@ OptCNF* sudoku_to_cnf(Sudoku* sudoku) {
             for (int i = 1; i <= SUDOKU_SIZE; i++) {
                 temp_literals[i-1] = (i-1)*81 + (j-1)*9 + k;
             }
-            add_clause(temp_literals, SUDOKU_SIZE);
+            opt_cnf_add_clause(cnf, temp_literals, SUDOKU_SIZE);
             
             // 最多一次
             for (int i1 = 1; i1 <= SUDOKU_SIZE; i1++) {
                 for (int i2 = i1 + 1; i2 <= SUDOKU_SIZE; i2++) {
                     temp_literals[0] = -((i1-1)*81 + (j-1)*9 + k);
                     temp_literals[1] = -((i2-1)*81 + (j-1)*9 + k);
-                    add_clause(temp_literals, 2);
+                    opt_cnf_add_clause(cnf, temp_literals, 2);
                 }
             }
         }
@@ -187,7 +152,7 @@ OptCNF* sudoku_to_cnf(Sudoku* sudoku) {
                         temp_literals[idx++] = (row-1)*81 + (col-1)*9 + k;
                     }
                 }
-                add_clause(temp_literals, 9);
+                opt_cnf_add_clause(cnf, temp_literals, 9);
                 
                 // 最多一次
                 for (int pos1 = 0; pos1 < 9; pos1++) {
@@ -201,7 +166,7 @@ OptCNF* sudoku_to_cnf(Sudoku* sudoku) {
                         
                         temp_literals[0] = -((row1-1)*81 + (col1-1)*9 + k);
                         temp_literals[1] = -((row2-1)*81 + (col2-1)*9 + k);
-                        add_clause(temp_literals, 2);
+                        opt_cnf_add_clause(cnf, temp_literals, 2);
                     }
                 }
             }
@@ -217,7 +182,7 @@ OptCNF* sudoku_to_cnf(Sudoku* sudoku) {
             int j = SUDOKU_SIZE - 1 - i;  // 反对角线位置
             temp_literals[i] = i*81 + j*9 + k;
         }
-        add_clause(temp_literals, SUDOKU_SIZE);
+        opt_cnf_add_clause(cnf, temp_literals, SUDOKU_SIZE);
         
         // 最多一次
         for (int i1 = 0; i1 < SUDOKU_SIZE; i1++) {
@@ -226,7 +191,7 @@ OptCNF* sudoku_to_cnf(Sudoku* sudoku) {
                 int j2 = SUDOKU_SIZE - 1 - i2;
                 temp_literals[0] = -(i1*81 + j1*9 + k);
                 temp_literals[1] = -(i2*81 + j2*9 + k);
-                add_clause(temp_literals, 2);
+                opt_cnf_add_clause(cnf, temp_literals, 2);
             }
         }
     }
@@ -240,7 +205,7 @@ OptCNF* sudoku_to_cnf(Sudoku* sudoku) {
             int j = upper_window_positions[p][1];
             temp_literals[p] = i*81 + j*9 + k;
         }
-        add_clause(temp_literals, 9);
+        opt_cnf_add_clause(cnf, temp_literals, 9);
         
         // 最多一次
         for (int p1 = 0; p1 < 9; p1++) {
@@ -251,7 +216,7 @@ OptCNF* sudoku_to_cnf(Sudoku* sudoku) {
                 int j2 = upper_window_positions[p2][1];
                 temp_literals[0] = -(i1*81 + j1*9 + k);
                 temp_literals[1] = -(i2*81 + j2*9 + k);
-                add_clause(temp_literals, 2);
+                opt_cnf_add_clause(cnf, temp_literals, 2);
             }
         }
     }
@@ -265,7 +230,7 @@ OptCNF* sudoku_to_cnf(Sudoku* sudoku) {
             int j = lower_window_positions[p][1];
             temp_literals[p] = i*81 + j*9 + k;
         }
-        add_clause(temp_literals, 9);
+        opt_cnf_add_clause(cnf, temp_literals, 9);
         
         // 最多一次
         for (int p1 = 0; p1 < 9; p1++) {
@@ -276,7 +241,7 @@ OptCNF* sudoku_to_cnf(Sudoku* sudoku) {
                 int j2 = lower_window_positions[p2][1];
                 temp_literals[0] = -(i1*81 + j1*9 + k);
                 temp_literals[1] = -(i2*81 + j2*9 + k);
-                add_clause(temp_literals, 2);
+                opt_cnf_add_clause(cnf, temp_literals, 2);
             }
         }
     }
@@ -287,7 +252,7 @@ OptCNF* sudoku_to_cnf(Sudoku* sudoku) {
             if (sudoku->grid[i][j] != EMPTY_CELL) {
                 int k = sudoku->grid[i][j];
                 temp_literals[0] = i*81 + j*9 + k;
-                add_clause(temp_literals, 1);
+                opt_cnf_add_clause(cnf, temp_literals, 1);
             }
         }
     }
@@ -306,67 +271,48 @@ int solve_sudoku_with_sat(Sudoku* sudoku, const char* output_prefix) {
         return 0;
     }
     
-    // 转换为标准CNF用于求解器
-    CNF cnf;
-    if (opt_cnf_to_cnf(opt_cnf, &cnf) != 0) {
-        free_opt_cnf(opt_cnf);
-        return 0;
-    }
-    
     // 保存CNF文件
     char cnf_filename[256];
     sprintf(cnf_filename, "%s.cnf", output_prefix);
     
     FILE* cnf_file = fopen(cnf_filename, "w");
     if (!cnf_file) {
-        free_cnf(&cnf);
         free_opt_cnf(opt_cnf);
+        free(opt_cnf);
         return 0;
     }
     
-    fprintf(cnf_file, "c Percent Sudoku SAT problem\n");
-    fprintf(cnf_file, "p cnf %d %zu\n", cnf.num_variables, cnf.num_clauses);
+    OutBuffer ob;
+    out_init(&ob, cnf_file);
+    out_puts(&ob, "c Percent Sudoku SAT problem\n");
+    out_printf(&ob, "p cnf %d %zu\n", opt_cnf->num_variables, opt_cnf->num_clauses);
     
-    for (size_t i = 0; i < cnf.num_clauses; i++) {
-        for (size_t j = 0; j < cnf.clauses[i].num_literals; j++) {
-            fprintf(cnf_file, "%d ", cnf.clauses[i].literals[j]);
-        }
-        fprintf(cnf_file, "0\n");
+    for (size_t i = 0; i < opt_cnf->num_clauses; i++) {
+        const ArenaClause* clause = arena_clause(&opt_cnf->arena, opt_cnf->clauses[i]);
+        out_clause(&ob, clause->lits, clause->size);
     }
+    out_flush(&ob);
     
     fclose(cnf_file);
     // Solving Sudoku
     // 创建求解器并求解
     Assignment model;
     double solve_time_ms = 0.0;
-    int result = dpll_solve(&cnf, &model, 30000, &solve_time_ms); // 30秒超时
+    int result = cdcl_solve_opt(opt_cnf, &model, NULL, NULL, 30000, &solve_time_ms); // 30秒超时
     
     // 保存结果
     char res_filename[256];
     sprintf(res_filename, "%s.res", output_prefix);
     
-    FILE* res_file = fopen(res_filename, "w");
-    if (res_file) {
-        int s_val = (result == 1) ? 1 : ((result == 0) ? 0 : -1);
-        fprintf(res_file, "s %d\n", s_val);
-        if (result == 1) {
-            fprintf(res_file, "v ");
-            for (int v = 1; v <= model.num_variables; ++v) {
-                int lit = model.values[v] >= 0 ? v : -v;
-                if (model.values[v] == 0) lit = v;
-                fprintf(res_file, "%d ", lit);
-            }
-            fprintf(res_file, "\n");
-        }
-        fprintf(res_file, "t %.0f\n", solve_time_ms);
-        fclose(res_file);
-    }
+    int s_val = (result == 1) ? 1 : ((result == 0) ? 0 : -1);
+    out_write_result(res_filename, s_val, result == 1 ? model.values : NULL, result == 1 ? model.num_variables : 0,
+                     solve_time_ms, 0);
     
     if (result == 1) {
         // Solution found
         
         // 验证解的正确性
-        verify_model_satisfies(&cnf, &model);
+        verify_model_satisfies_opt(opt_cnf, &model);
         
         // 从解中恢复数独并填充到原数独中
         for (int i = 0; i < SUDOKU_SIZE; i++) {
@@ -387,7 +333,7 @@ int solve_sudoku_with_sat(Sudoku* sudoku, const char* output_prefix) {
         free_assignment(&model);
     }
     
-    free_cnf(&cnf);
     free_opt_cnf(opt_cnf);
+    free(opt_cnf);
     return (result == 1);
 }
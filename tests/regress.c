@@ -0,0 +1,149 @@
+// regress.c - Regression tests for the parsers, the solvers and the model check
+// Run from the repository root: make test
+#include "parser_opt.h"
+#include "solver.h"
+#include "check.h"
+#include <stdio.h>
+#include <string.h>
+
+static int failures = 0;
+
+#define EXPECT(cond) do { \
+	if (!(cond)) { fprintf(stderr, "%s:%d: %s\n", __FILE__, __LINE__, #cond); failures++; } \
+} while (0)
+
+static size_t count_empty(const OptCNF *cnf) {
+	size_t n = 0;
+	for (size_t i = 0; i < cnf->num_clauses; ++i) {
+		if (arena_clause(&cnf->arena, cnf->clauses[i])->size == 0) n++;
+	}
+	return n;
+}
+
+static void test_empty_clause(void) {
+	static const char text[] = "p cnf 3 4\n1 2 0\n-1 3 0\n0\n-2 -3 0\n";
+	const char *path = "cases/small/u-empty-clause.cnf";
+	OptCNF cnfs[5];
+	EXPECT(parse_cnf_file_opt(path, &cnfs[0]) == 0);
+	EXPECT(parse_cnf_file_mmap(path, &cnfs[1]) == 0);
+	EXPECT(parse_cnf_file_parallel(path, &cnfs[2], 4) == 0);
+	EXPECT(parse_cnf_buffer_kernel(text, sizeof(text) - 1, &cnfs[3], PARSE_KERNEL_SCALAR) == 0);
+	EXPECT(parse_cnf_buffer_kernel(text, sizeof(text) - 1, &cnfs[4], PARSE_KERNEL_AVX2) == 0);
+	for (int k = 0; k < 5; ++k) {
+		EXPECT(cnfs[k].num_clauses == 4);
+		EXPECT(count_empty(&cnfs[k]) == 1);
+	}
+	Assignment m;
+	EXPECT(cdcl_solve_opt(&cnfs[0], &m, NULL, NULL, 0, NULL) == 0);
+	EXPECT(dpll_solve_opt(&cnfs[0], &m, 0, NULL) == 0);
+	// Satisfies every clause except the empty one
+	EXPECT(init_assignment(&m, 3) == 0);
+	m.values[1] = 1;
+	m.values[2] = -1;
+	m.values[3] = 1;
+	EXPECT(verify_model_satisfies_opt(&cnfs[0], &m) == 0);
+	CheckStats st;
+	EXPECT(check_model(&cnfs[0], &m, 1, &st) == 0);
+	EXPECT(st.failed_clause == 2);
+	free_assignment(&m);
+	for (int k = 0; k < 5; ++k) free_opt_cnf(&cnfs[k]);
+}
+
+// Every parser reads "+2" as 2 and "-0" as a terminator, like atoi
+static void test_signed_literals(void) {
+	static const char text[] = "p cnf 3 3\n1 +2 0\n-0 3 0\n";
+	const char *path = "cases/small/u-signed-literals.cnf";
+	OptCNF cnfs[6];
+	EXPECT(parse_cnf_file_opt(path, &cnfs[0]) == 0);
+	EXPECT(parse_cnf_file_mmap(path, &cnfs[1]) == 0);
+	EXPECT(parse_cnf_file_parallel(path, &cnfs[2], 4) == 0);
+	EXPECT(parse_cnf_buffer_kernel(text, sizeof(text) - 1, &cnfs[3], PARSE_KERNEL_SCALAR) == 0);
+	EXPECT(parse_cnf_buffer_kernel(text, sizeof(text) - 1, &cnfs[4], PARSE_KERNEL_SSE42) == 0);
+	EXPECT(parse_cnf_buffer_kernel(text, sizeof(text) - 1, &cnfs[5], PARSE_KERNEL_AVX2) == 0);
+	for (int k = 0; k < 6; ++k) {
+		if (cnfs[k].num_clauses != 3) {
+			EXPECT(cnfs[k].num_clauses == 3);
+			continue;
+		}
+		const ArenaClause *a = arena_clause(&cnfs[k].arena, cnfs[k].clauses[0]);
+		const ArenaClause *b = arena_clause(&cnfs[k].arena, cnfs[k].clauses[1]);
+		const ArenaClause *c = arena_clause(&cnfs[k].arena, cnfs[k].clauses[2]);
+		EXPECT(a->size == 2 && a->lits[0] == 1 && a->lits[1] == 2);
+		EXPECT(b->size == 0);
+		EXPECT(c->size == 1 && c->lits[0] == 3);
+	}
+	for (int k = 0; k < 6; ++k) free_opt_cnf(&cnfs[k]);
+}
+
+static int has_lit(const int *lits, int n, int lit) {
+	for (int i = 0; i < n; ++i) {
+		if (lits[i] == lit) return 1;
+	}
+	return 0;
+}
+
+static void test_empty_formula(void) {
+	Solver *s = solver_new(NULL);
+	Assignment m;
+	EXPECT(s != NULL);
+	EXPECT(solver_solve(s, NULL, 0, &m, 0, NULL) == 1);
+	EXPECT(m.num_variables == 0);
+	free_assignment(&m);
+	solver_free(s);
+}
+
+static void test_assumptions(void) {
+	Solver *s = solver_new(NULL);
+	EXPECT(s != NULL);
+	static const int clause[] = {-1, 2};
+	EXPECT(solver_add_clause(s, clause, 2) == 0);
+	int core[9];
+
+	// Repeated, more often than there are variables
+	static const int dup[] = {1, 1, 1, 1, 1, 1, 1, 1};
+	EXPECT(solver_solve(s, dup, 2, NULL, 0, NULL) == 1);
+	EXPECT(solver_solve(s, dup, 8, NULL, 0, NULL) == 1);
+	EXPECT(solver_value(s, 2) == 1);
+
+	// Both polarities: UNSAT with both in the core, the formula itself is fine
+	static const int both[] = {1, -1};
+	EXPECT(solver_solve(s, both, 2, NULL, 0, NULL) == 0);
+	int n = solver_failed_assumptions(s, core);
+	EXPECT(n == 2 && has_lit(core, n, 1) && has_lit(core, n, -1));
+	EXPECT(solver_solve(s, NULL, 0, NULL, 0, NULL) == 1);
+
+	// Variables no clause has mentioned yet
+	static const int fresh[] = {5, -4};
+	Assignment m;
+	EXPECT(solver_solve(s, fresh, 2, &m, 0, NULL) == 1);
+	EXPECT(solver_num_vars(s) == 5);
+	EXPECT(m.num_variables == 5 && m.values[5] == 1 && m.values[4] == -1);
+	free_assignment(&m);
+	static const int fresh_both[] = {7, 1, -7};
+	EXPECT(solver_solve(s, fresh_both, 3, NULL, 0, NULL) == 0);
+	n = solver_failed_assumptions(s, core);
+	EXPECT(has_lit(core, n, 7) && has_lit(core, n, -7) && !has_lit(core, n, 1));
+	static const int implied[] = {1, -2};
+	EXPECT(solver_solve(s, implied, 2, NULL, 0, NULL) == 0);
+	n = solver_failed_assumptions(s, core);
+	EXPECT(n == 2 && has_lit(core, n, 1) && has_lit(core, n, -2));
+
+	// A zero literal fails the call but leaves the solver usable
+	static const int zero[] = {1, 0};
+	EXPECT(solver_solve(s, zero, 2, NULL, 0, NULL) == -2);
+	EXPECT(solver_solve(s, NULL, 0, NULL, 0, NULL) == 1);
+	solver_free(s);
+}
+
+int main(void) {
+	test_empty_clause();
+	test_signed_literals();
+	test_empty_formula();
+	test_assumptions();
+	if (failures) {
+		fprintf(stderr, "%d check(s) failed\n", failures);
+		return 1;
+	}
+	printf("all tests passed\n");
+	return 0;
+}